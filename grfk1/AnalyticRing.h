@@ -0,0 +1,49 @@
+#ifndef ANALYTICRING_H
+#define ANALYTICRING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Shader.h"
+
+// Planetary ring drawn as one quad in the ring plane (ring_vertex_shader.glsl).
+// ring_fragment_shader.glsl intersects the view ray with the annulus, so the edges
+// are exact at any zoom and the cost does not depend on any tessellation.
+// Radii are in units of the planet radius, i.e. relative to the planet's model matrix.
+class AnalyticRing {
+public:
+    AnalyticRing(float innerRadius, float outerRadius) : innerRadius(innerRadius), outerRadius(outerRadius) {
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+    }
+
+    void bind() const {
+        glBindVertexArray(VAO);
+    }
+
+    unsigned int vertexArray() const {
+        return VAO;
+    }
+
+    // Draw around the planet given by planetModel, the shader must be in use and the VAO bound
+    void draw(Shader& shader, const glm::mat4& planetModel) const {
+        shader.setMat4("model", planetModel);
+        shader.setFloat("innerRadius", innerRadius);
+        shader.setFloat("outerRadius", outerRadius);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+    // Outer edge in planet radii, for bounding spheres
+    float extent() const {
+        return outerRadius;
+    }
+
+private:
+    unsigned int VAO;
+    float innerRadius;
+    float outerRadius;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef BODYINSTANCES_H
+#define BODYINSTANCES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include "MeshArena.h"
+#include "ProceduralSphere.h"
+#include "StreamBuffer.h"
+#include "Shader.h"
+
+// One body in an instanced draw
+struct BodyInstance {
+    glm::mat4 model;
+    float layer;    // in the body TextureArray
+    bool emissive;
+    int surface;    // procedural surface in fragment_shader.glsl, 0 samples the texture
+};
+
+// Draws many bodies sharing one mesh with a single instanced call. The per-instance
+// model matrix, normal matrix, texture layer and surface are written into the stream buffer
+// each frame and read through attributes 3..10 (vertex_shader.glsl and
+// sphere_vertex_shader.glsl built with INSTANCED).
+class BodyInstances {
+public:
+    static const unsigned int FLOATS_PER_INSTANCE = 32; // mat4, mat3 as three vec4, layer, emissive and surface padded to a vec4
+
+    explicit BodyInstances(StreamBuffer& stream) : stream(&stream), fallbackCapacity(0), instanceBuffer(0) {
+        glGenVertexArrays(1, &meshVAO);
+        glGenVertexArrays(1, &proceduralVAO);
+        glGenBuffers(1, &fallbackVBO);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &meshVAO);
+        glDeleteVertexArrays(1, &proceduralVAO);
+        glDeleteBuffers(1, &fallbackVBO);
+    }
+
+    BodyInstances(const BodyInstances&) = delete;
+    BodyInstances& operator=(const BodyInstances&) = delete;
+
+    // VAO for drawMesh and drawProcedural, the matching one must be bound when drawing
+    unsigned int meshVertexArray() const {
+        return meshVAO;
+    }
+
+    unsigned int proceduralVertexArray() const {
+        return proceduralVAO;
+    }
+
+    // All instances of an arena mesh in one glDrawElementsInstancedBaseVertex
+    void drawMesh(const MeshArena& arena, const MeshHandle& mesh, const std::vector<BodyInstance>& instances) {
+        if (!mesh.valid() || instances.empty())
+            return;
+        setMeshAttributes(arena);
+        pointInstances(uploadInstances(instances));
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+            (void*)(mesh.firstIndex * sizeof(unsigned int)), (GLsizei)instances.size(), mesh.baseVertex);
+    }
+
+    // All instances of the gl_VertexID sphere with one tessellation in one glDrawArraysInstanced
+    void drawProcedural(Shader& shader, unsigned int longitudeSegments, unsigned int latitudeSegments, const std::vector<BodyInstance>& instances) {
+        if (instances.empty())
+            return;
+        pointInstances(uploadInstances(instances));
+        shader.setInt("longitudeSegments", (int)longitudeSegments);
+        shader.setInt("latitudeSegments", (int)latitudeSegments);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, (GLsizei)(longitudeSegments * latitudeSegments * 6), (GLsizei)instances.size());
+    }
+
+    // Point attributes 0..2 and the index buffer of the bound VAO at the arena,
+    // whose buffers may have been replaced since the last frame
+    void setMeshAttributes(const MeshArena& arena) {
+        glBindBuffer(GL_ARRAY_BUFFER, arena.vertexBuffer());
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.indexBuffer());
+    }
+
+    // Pack the instances into this frame's part of the stream buffer, returns their byte offset
+    size_t uploadInstances(const std::vector<BodyInstance>& instances) {
+        packed.resize(instances.size() * FLOATS_PER_INSTANCE);
+        for (size_t i = 0; i < instances.size(); ++i) {
+            float* out = &packed[i * FLOATS_PER_INSTANCE];
+            const glm::mat4& model = instances[i].model;
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+            for (int column = 0; column < 4; ++column)
+                for (int row = 0; row < 4; ++row)
+                    out[column * 4 + row] = model[column][row];
+            for (int column = 0; column < 3; ++column) {
+                for (int row = 0; row < 3; ++row)
+                    out[16 + column * 4 + row] = normalMatrix[column][row];
+                out[16 + column * 4 + 3] = 0.0f;
+            }
+            out[28] = instances[i].layer;
+            out[29] = instances[i].emissive ? 1.0f : 0.0f;
+            out[30] = (float)instances[i].surface;
+            out[31] = 0.0f;
+        }
+
+        size_t bytes = packed.size() * sizeof(float);
+        size_t offset;
+        void* destination = stream->allocate(bytes, offset);
+        if (destination) {
+            memcpy(destination, packed.data(), bytes);
+            stream->commit();
+            instanceBuffer = stream->buffer();
+            return offset;
+        }
+        // Stream region full: orphan a private buffer instead
+        glBindBuffer(GL_ARRAY_BUFFER, fallbackVBO);
+        fallbackCapacity = std::max(fallbackCapacity, bytes);
+        glBufferData(GL_ARRAY_BUFFER, fallbackCapacity, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, packed.data());
+        instanceBuffer = fallbackVBO;
+        return 0;
+    }
+
+    // Point attributes 3..10 of the bound VAO at uploaded instances starting at offset
+    void pointInstances(size_t offset) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        GLsizei stride = FLOATS_PER_INSTANCE * sizeof(float);
+        for (unsigned int column = 0; column < 4; ++column)
+            setInstanceAttribute(3 + column, 4, offset + column * 4 * sizeof(float), stride);
+        for (unsigned int column = 0; column < 3; ++column)
+            setInstanceAttribute(7 + column, 3, offset + (16 + column * 4) * sizeof(float), stride);
+        setInstanceAttribute(10, 3, offset + 28 * sizeof(float), stride);
+    }
+
+private:
+    StreamBuffer* stream;
+    unsigned int meshVAO, proceduralVAO;
+    unsigned int fallbackVBO;
+    size_t fallbackCapacity;
+    unsigned int instanceBuffer;
+    std::vector<float> packed;
+
+    static void setInstanceAttribute(unsigned int location, int size, size_t offset, GLsizei stride) {
+        glVertexAttribPointer(location, size, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+};
+
+#endif
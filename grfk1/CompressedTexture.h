@@ -0,0 +1,232 @@
+#ifndef COMPRESSEDTEXTURE_H
+#define COMPRESSEDTEXTURE_H
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "MappedFile.h"
+
+// EXT_texture_compression_s3tc is not part of the GL 3.3 loader
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// Pre-filtered, block-compressed mip chain written by tools/texcook:
+//
+//   Header | Level[levelCount] | payloads (each aligned to PAYLOAD_ALIGNMENT)
+//
+// Level 0 is the full image, every level is stored bottom row first like the
+// flipped stb_image output. The table and every payload carry a checksum.
+class CompressedTexture {
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t FORMAT_BC1 = 1; // DXT1, RGB, 8 bytes per 4x4 block
+    static const uint32_t FORMAT_BC3 = 3; // DXT5, RGBA, 16 bytes per 4x4 block
+
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+        const unsigned char* data;
+        size_t size;
+    };
+
+    // Cooked file next to the source image: textures/earth.bmp -> textures/earth.gktx
+    static std::string cookedPath(const std::string& sourcePath) {
+        size_t dot = sourcePath.find_last_of('.');
+        size_t slash = sourcePath.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            dot = sourcePath.size();
+        return sourcePath.substr(0, dot) + ".gktx";
+    }
+
+    // Look for EXT_texture_compression_s3tc, call once after gladLoadGLLoader
+    static void loadExtensions() {
+        bool found = false;
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount && !found; ++i)
+            found = std::strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_EXT_texture_compression_s3tc") == 0;
+        s3tc() = found;
+    }
+
+    // Without S3TC the BC1/BC3 levels cannot be uploaded, callers use the source image instead
+    static bool supported() {
+        return s3tc();
+    }
+
+    static size_t blockBytes(uint32_t format) {
+        return format == FORMAT_BC1 ? 8 : 16;
+    }
+
+    static size_t levelSize(uint32_t format, uint32_t width, uint32_t height) {
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+    }
+
+    // Map and validate a cooked file, false when missing, stale or corrupt
+    bool open(const std::string& path) {
+        levelTable.clear();
+        if (!file.open(path) || !validate(file.data(), file.size())) {
+            file.close();
+            levelTable.clear();
+            return false;
+        }
+        return true;
+    }
+
+    // Validate a cooked file already in memory (a TexturePack entry), which must outlive this object
+    bool view(const unsigned char* data, size_t size) {
+        file.close();
+        levelTable.clear();
+        if (!validate(data, size)) {
+            levelTable.clear();
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t format() const { return textureFormat; }
+    uint32_t width() const { return levelTable.empty() ? 0 : levelTable[0].width; }
+    uint32_t height() const { return levelTable.empty() ? 0 : levelTable[0].height; }
+    const std::vector<Level>& levels() const { return levelTable; }
+
+    GLenum internalFormat() const {
+        return textureFormat == FORMAT_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    }
+
+    // Upload every level to the bound GL_TEXTURE_2D
+    void upload() const {
+        for (size_t level = 0; level < levelTable.size(); ++level)
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, internalFormat(), levelTable[level].width, levelTable[level].height, 0,
+                (GLsizei)levelTable[level].size, levelTable[level].data);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levelTable.size() - 1);
+    }
+
+    // Write a mip chain, replacing any older file atomically
+    static bool store(const std::string& path, uint32_t format, uint32_t width, uint32_t height, const std::vector<std::vector<unsigned char>>& levels) {
+        std::vector<LevelEntry> entries(levels.size());
+        uint64_t offset = align(sizeof(Header) + entries.size() * sizeof(LevelEntry));
+        for (size_t level = 0; level < levels.size(); ++level) {
+            entries[level].width = std::max(1u, width >> level);
+            entries[level].height = std::max(1u, height >> level);
+            entries[level].offset = offset;
+            entries[level].size = levels[level].size();
+            entries[level].checksum = checksum(levels[level].data(), levels[level].size());
+            offset = align(offset + levels[level].size());
+        }
+        Header header = {};
+        memcpy(header.magic, magic(), 4);
+        header.version = VERSION;
+        header.format = format;
+        header.levelCount = (uint32_t)levels.size();
+        header.fileSize = offset;
+        header.tableChecksum = checksum(entries.data(), entries.size() * sizeof(LevelEntry));
+
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            out.write((const char*)&header, sizeof(header));
+            out.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(LevelEntry)));
+            static const char padding[PAYLOAD_ALIGNMENT] = {};
+            uint64_t written = sizeof(header) + entries.size() * sizeof(LevelEntry);
+            for (size_t level = 0; level < levels.size(); ++level) {
+                out.write(padding, (std::streamsize)(entries[level].offset - written));
+                out.write((const char*)levels[level].data(), (std::streamsize)levels[level].size());
+                written = entries[level].offset + entries[level].size;
+            }
+            out.write(padding, (std::streamsize)(offset - written));
+            if (!out)
+                return false;
+        }
+        std::remove(path.c_str());
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+
+private:
+    static const size_t PAYLOAD_ALIGNMENT = 16;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t format;
+        uint32_t levelCount;
+        uint64_t fileSize;
+        uint64_t tableChecksum;
+    };
+
+    struct LevelEntry {
+        uint32_t width;
+        uint32_t height;
+        uint64_t offset;
+        uint64_t size;
+        uint64_t checksum;
+    };
+
+    MappedFile file;
+    uint32_t textureFormat = 0;
+    std::vector<Level> levelTable;
+
+    static bool& s3tc() {
+        static bool supported = false;
+        return supported;
+    }
+
+    static const char* magic() {
+        return "GKTX";
+    }
+
+    static uint64_t align(uint64_t value) {
+        return (value + PAYLOAD_ALIGNMENT - 1) & ~(uint64_t)(PAYLOAD_ALIGNMENT - 1);
+    }
+
+    // FNV-1a over 64-bit words, bytewise for the tail (same as MeshCache)
+    static uint64_t checksum(const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        uint64_t hash = 0xCBF29CE484222325ull;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            hash = (hash ^ word) * 0x100000001B3ull;
+        }
+        for (; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        return hash ^ size;
+    }
+
+    bool validate(const unsigned char* data, size_t size) {
+        if (size < sizeof(Header))
+            return false;
+        Header header;
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, magic(), 4) != 0 || header.version != VERSION || header.fileSize != size
+            || (header.format != FORMAT_BC1 && header.format != FORMAT_BC3) || header.levelCount == 0 || header.levelCount > 32
+            || sizeof(Header) + header.levelCount * sizeof(LevelEntry) > size)
+            return false;
+        const LevelEntry* entries = (const LevelEntry*)(data + sizeof(Header));
+        if (checksum(entries, header.levelCount * sizeof(LevelEntry)) != header.tableChecksum)
+            return false;
+        textureFormat = header.format;
+        for (uint32_t level = 0; level < header.levelCount; ++level) {
+            const LevelEntry& entry = entries[level];
+            // offset + size could wrap on a corrupt table
+            if (entry.offset > size || entry.size > size - entry.offset || entry.size != levelSize(header.format, entry.width, entry.height)
+                || checksum(data + entry.offset, (size_t)entry.size) != entry.checksum)
+                return false;
+            Level mapped = { entry.width, entry.height, data + entry.offset, (size_t)entry.size };
+            levelTable.push_back(mapped);
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef FRUSTUMCULLER_H
+#define FRUSTUMCULLER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include "ThreadPool.h"
+
+// Widest instruction set the compiler targets; /arch:AVX (or -mavx) enables 8 spheres
+// per step, x64 always has SSE2. Define FRUSTUM_NO_SIMD for the scalar path.
+#if !defined(FRUSTUM_NO_SIMD) && defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_AVX
+#elif !defined(FRUSTUM_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define FRUSTUM_SSE
+#endif
+
+struct CullStats {
+    size_t tested = 0;
+    size_t visible = 0;
+    unsigned int threads = 0;
+    double milliseconds = 0.0;
+};
+
+// Bounding spheres kept as separate x, y, z, radius arrays (padded to the SIMD width)
+// and tested against the six planes of projection * view several at a time.
+// cull() leaves the indices of the spheres that touch the frustum in visible().
+class FrustumCuller {
+public:
+#if defined(FRUSTUM_AVX)
+    static const size_t WIDTH = 8;
+#elif defined(FRUSTUM_SSE)
+    static const size_t WIDTH = 4;
+#else
+    static const size_t WIDTH = 1;
+#endif
+    // Below this many spheres threads cost more than they save
+    static const size_t PARALLEL_MIN = 16384;
+
+    FrustumCuller() : count(0) {
+    }
+
+    void clear() {
+        count = 0;
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+    }
+
+    // Returns the index reported by visible()
+    unsigned int add(const glm::vec3& center, float sphereRadius) {
+        x.push_back(center.x);
+        y.push_back(center.y);
+        z.push_back(center.z);
+        radius.push_back(sphereRadius);
+        return (unsigned int)count++;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    // Gribb-Hartmann: planes from the rows of the matrix, normalized so the
+    // distance can be compared with the radius
+    void setFrustum(const glm::mat4& viewProjection) {
+        glm::vec4 rows[4];
+        for (int row = 0; row < 4; ++row)
+            rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+        for (int axis = 0; axis < 3; ++axis) {
+            planes[axis * 2] = rows[3] + rows[axis];
+            planes[axis * 2 + 1] = rows[3] - rows[axis];
+        }
+        for (glm::vec4& plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    // Test every sphere, split across the pool for large counts
+    const std::vector<unsigned int>& cull(ThreadPool* pool = nullptr) {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        pad();
+        size_t blocks = x.size() / WIDTH;
+        visibleIndices.clear();
+        stats.threads = 1;
+        if (pool && count >= PARALLEL_MIN) {
+            unsigned int parts = (unsigned int)std::min<size_t>(blocks, pool->size() + 1);
+            partVisible.resize(parts);
+            pool->parallelFor(blocks, [this](size_t begin, size_t end, unsigned int part) {
+                partVisible[part].clear();
+                cullRange(begin * WIDTH, end * WIDTH, partVisible[part]);
+            });
+            for (unsigned int part = 0; part < parts; ++part)
+                visibleIndices.insert(visibleIndices.end(), partVisible[part].begin(), partVisible[part].end());
+            stats.threads = parts;
+        }
+        else {
+            cullRange(0, blocks * WIDTH, visibleIndices);
+        }
+        stats.tested = count;
+        stats.visible = visibleIndices.size();
+        stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        return visibleIndices;
+    }
+
+    const std::vector<unsigned int>& visible() const {
+        return visibleIndices;
+    }
+
+    const CullStats& lastStats() const {
+        return stats;
+    }
+
+private:
+    std::vector<float> x, y, z, radius;
+    size_t count;
+    glm::vec4 planes[6];
+    std::vector<unsigned int> visibleIndices;
+    std::vector<std::vector<unsigned int>> partVisible;
+    CullStats stats;
+
+    // Padding spheres have a radius of -inf, so they fail every plane
+    void pad() {
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+        radius.resize(count);
+        size_t padded = (count + WIDTH - 1) / WIDTH * WIDTH;
+        x.resize(padded, 0.0f);
+        y.resize(padded, 0.0f);
+        z.resize(padded, 0.0f);
+        radius.resize(padded, -std::numeric_limits<float>::infinity());
+    }
+
+    // [begin, end) are multiples of WIDTH
+    void cullRange(size_t begin, size_t end, std::vector<unsigned int>& out) const {
+#if defined(FRUSTUM_AVX)
+        for (size_t i = begin; i < end; i += WIDTH) {
+            __m256 cx = _mm256_loadu_ps(&x[i]), cy = _mm256_loadu_ps(&y[i]), cz = _mm256_loadu_ps(&z[i]);
+            __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&radius[i]));
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const glm::vec4& plane : planes) {
+                __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), cx), _mm256_mul_ps(_mm256_set1_ps(plane.y), cy)),
+                                                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), cz), _mm256_set1_ps(plane.w)));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+            }
+            appendLanes(_mm256_movemask_ps(inside), i, out);
+        }
+#elif defined(FRUSTUM_SSE)
+        for (size_t i = begin; i < end; i += WIDTH) {
+            __m128 cx = _mm_loadu_ps(&x[i]), cy = _mm_loadu_ps(&y[i]), cz = _mm_loadu_ps(&z[i]);
+            __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const glm::vec4& plane : planes) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx), _mm_mul_ps(_mm_set1_ps(plane.y), cy)),
+                                             _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), cz), _mm_set1_ps(plane.w)));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+            }
+            appendLanes(_mm_movemask_ps(inside), i, out);
+        }
+#else
+        for (size_t i = begin; i < end; ++i) {
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; ++p)
+                inside = planes[p].x * x[i] + planes[p].y * y[i] + planes[p].z * z[i] + planes[p].w >= -radius[i];
+            if (inside)
+                out.push_back((unsigned int)i);
+        }
+#endif
+    }
+
+    static void appendLanes(int mask, size_t first, std::vector<unsigned int>& out) {
+        for (unsigned int lane = 0; mask; ++lane, mask >>= 1)
+            if (mask & 1)
+                out.push_back((unsigned int)(first + lane));
+    }
+};
+
+#endif
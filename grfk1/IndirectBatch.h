@@ -0,0 +1,128 @@
+#ifndef INDIRECTBATCH_H
+#define INDIRECTBATCH_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstring>
+#include "MeshArena.h"
+#include "StreamBuffer.h"
+#include "BodyInstances.h"
+
+// ARB_multi_draw_indirect / GL 4.3 is not part of the GL 3.3 loader
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+// Layout read by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Arena meshes of a frame collected on the CPU into one command stream and submitted
+// with a single glMultiDrawElementsIndirect. Without GL 4.3 (or ARB_multi_draw_indirect
+// and ARB_base_instance) the same commands run as a loop of glDrawElementsInstancedBaseVertex,
+// re-pointing the instance attributes whenever baseInstance changes.
+class IndirectBatch {
+public:
+    // Look up glMultiDrawElementsIndirect, call once after gladLoadGLLoader
+    static void loadExtensions(GLADloadproc load) {
+        bool supported = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3);
+        bool multiDraw = false, baseInstance = false;
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount && !supported; ++i) {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            multiDraw = multiDraw || std::strcmp(name, "GL_ARB_multi_draw_indirect") == 0;
+            baseInstance = baseInstance || std::strcmp(name, "GL_ARB_base_instance") == 0;
+            supported = multiDraw && baseInstance;
+        }
+        multiDrawElementsIndirect() = supported ? (MultiDrawElementsIndirectProc)load("glMultiDrawElementsIndirect") : nullptr;
+    }
+
+    static bool multiDrawSupported() {
+        return multiDrawElementsIndirect() != nullptr;
+    }
+
+    void clear() {
+        instances.clear();
+        commands.clear();
+    }
+
+    // Returns the index to pass as firstInstance
+    unsigned int addInstance(const BodyInstance& instance) {
+        instances.push_back(instance);
+        return (unsigned int)(instances.size() - 1);
+    }
+
+    void addDraw(const MeshHandle& mesh, unsigned int firstInstance, unsigned int instanceCount = 1) {
+        if (!mesh.valid() || instanceCount == 0)
+            return;
+        DrawElementsIndirectCommand command;
+        command.count = mesh.indexCount;
+        command.instanceCount = instanceCount;
+        command.firstIndex = mesh.firstIndex;
+        command.baseVertex = mesh.baseVertex;
+        command.baseInstance = firstInstance;
+        commands.push_back(command);
+    }
+
+    size_t drawCount() const {
+        return commands.size();
+    }
+
+    size_t instanceCount() const {
+        return instances.size();
+    }
+
+    // Submit everything, the VAO of bodies.meshVertexArray() must be bound.
+    // multiDraw = false forces the fallback loop (for comparisons).
+    void draw(BodyInstances& bodies, const MeshArena& arena, StreamBuffer& stream, bool multiDraw = true) {
+        if (commands.empty())
+            return;
+        bodies.setMeshAttributes(arena);
+        size_t instanceOffset = bodies.uploadInstances(instances);
+        bodies.pointInstances(instanceOffset);
+
+        if (multiDraw && multiDrawSupported()) {
+            size_t bytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+            size_t commandOffset;
+            void* destination = stream.allocate(bytes, commandOffset);
+            if (destination) {
+                memcpy(destination, commands.data(), bytes);
+                stream.commit();
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, stream.buffer());
+                multiDrawElementsIndirect()(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)commandOffset, (GLsizei)commands.size(), 0);
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+                return;
+            }
+        }
+
+        GLuint pointedInstance = 0;
+        for (size_t i = 0; i < commands.size(); ++i) {
+            const DrawElementsIndirectCommand& command = commands[i];
+            if (command.baseInstance != pointedInstance) {
+                bodies.pointInstances(instanceOffset + command.baseInstance * BodyInstances::FLOATS_PER_INSTANCE * sizeof(float));
+                pointedInstance = command.baseInstance;
+            }
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                (void*)(command.firstIndex * sizeof(unsigned int)), command.instanceCount, command.baseVertex);
+        }
+    }
+
+private:
+    typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+    std::vector<BodyInstance> instances;
+    std::vector<DrawElementsIndirectCommand> commands;
+
+    static MultiDrawElementsIndirectProc& multiDrawElementsIndirect() {
+        static MultiDrawElementsIndirectProc proc = nullptr;
+        return proc;
+    }
+};
+
+#endif
@@ -1,313 +1,695 @@
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-#include <iostream>
-#include "Shader.h"
-#include "Camera.h"
-#include "Object.h"
-#include "Texture.h"
-#define NUM_LIGHTS 6
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
-// Wielkosc okna
-const unsigned int SCR_WIDTH = 1200;
-const unsigned int SCR_HEIGHT = 900;
-
-// Kamera
-Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
-float lastX = SCR_WIDTH / 2.0f;
-float lastY = SCR_HEIGHT / 2.0f;
-bool firstMouse = true;
-
-// Czas
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
-
-// Funkcje
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-void processInput(GLFWwindow* window);
-
-// To
-float backgroundVertices[] = {
-    // positions   // texCoords
-    -1.0f,  1.0f,  0.0f, 1.0f,
-    -1.0f, -1.0f,  0.0f, 0.0f,
-     1.0f, -1.0f,  1.0f, 0.0f,
-
-    -1.0f,  1.0f,  0.0f, 1.0f,
-     1.0f, -1.0f,  1.0f, 0.0f,
-     1.0f,  1.0f,  1.0f, 1.0f
-};
-
-unsigned int backgroundVAO, backgroundVBO;
-
-int main() {
-    //GLFW
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // Tworzenie okna
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Projekt - Uklad sloneczny", NULL, NULL);
-    if (window == NULL) {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-    //GLAD
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
-
-    glEnable(GL_DEPTH_TEST);
-
-    // shader ta
-    Shader backgroundShader("background_vertex_shader.glsl", "background_fragment_shader.glsl");
-
-    // tekstura ta
-    Texture backgroundTexture("textures/bg.bmp");
-
-    // setup VAO ta
-    glGenVertexArrays(1, &backgroundVAO);
-    glGenBuffers(1, &backgroundVBO);
-    glBindVertexArray(backgroundVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, backgroundVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(backgroundVertices), backgroundVertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
-
-    // shadery
-    Shader shader("vertex_shader.glsl", "fragment_shader.glsl");
-
-    // Wczytywanie modeli planet
-    Object sun;
-    Texture sunTexture("textures/sun.bmp");
-    Texture planetTextures[8] = {
-    Texture("textures/mercury.bmp"),
-    Texture("textures/venus.bmp"),
-    Texture("textures/earth.bmp"),
-    Texture("textures/mars.bmp"),
-    Texture("textures/jupiter.bmp"),
-    Texture("textures/saturn.bmp"),
-    Texture("textures/uranus.bmp"),
-    Texture("textures/neptun.bmp")
-    };
-
-    // Definicja planet
-    Object planets[8];
-    for (int i = 0; i < 8; ++i) {
-        planets[i].loadModel("textures/planet.obj");
-    }
-
-    // Saturn ring
-    Object saturnRing;
-    saturnRing.setupRingMesh(1.2f, 2.0f, 64);
-    Texture ringTexture("textures/saturn_ring.bmp");
-
-    // Gwna ptla renderujca
-    while (!glfwWindowShouldClose(window)) {
-        // Czas pomidzy klatkami
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        // Obsuga wejcia
-        processInput(window);
-
-        // Renderowanie
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
-
-        // Renderowanie ta
-        backgroundShader.use();
-        glBindVertexArray(backgroundVAO);
-        backgroundTexture.bind();
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
-
-        // Enable depth testing
-        glEnable(GL_DEPTH_TEST);
-
-
-        glm::vec3 lightPositions[NUM_LIGHTS] = { 
-            glm::vec3(2.0f, 0.0f, 0.0f),  // right
-            glm::vec3(-2.0f, 0.0f, 0.0f), // left 
-            glm::vec3(0.0f, 2.0f, 0.0f),  // above 
-            glm::vec3(0.0f, -2.0f, 0.0f), // below 
-            glm::vec3(0.0f, 0.0f, 2.0f),  // in front
-            glm::vec3(0.0f, 0.0f, -2.0f)  // behind 
-        };
-        
-        shader.use();
-        for (unsigned int i = 0; i < NUM_LIGHTS; i++)
-        {
-            std::string lightPosName = "lightPos[" + std::to_string(i) + "]";
-            shader.setVec3(lightPosName, lightPositions[i]);
-        }
-        shader.setVec3("viewPos", camera.Position);
-
-        // Matryce przeksztace
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        shader.setMat4("projection", projection);
-        shader.setMat4("view", view);
-
-        // Render sun
-        shader.setBool("isSun", true); 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::scale(model, glm::vec3(1.0f)); // Sun is bigger
-        shader.setMat4("model", model);
-        sunTexture.bind();
-        sun.draw(shader);
-
-
-
-        shader.setBool("isSun", false); // Indicate that we are rendering planets
-        for (int i = 0; i < 8; ++i) {
-            // Nowy matrix dla kazdej planety
-            glm::mat4 model = glm::mat4(1.0f);
-
-            // Rotacja planet
-            //float rotationSpeed = 0.015f * (i + 1); // Predkosc rotacji planet wokol slonca
-            //float rotationSpeed = 0.0f;
-
-            float rotationSpeed;
-            switch (i) {
-            case 0: rotationSpeed = 0.24f; break;
-            case 1: rotationSpeed = 0.21f; break;
-            case 2: rotationSpeed = 0.18f; break;
-            case 3: rotationSpeed = 0.15f; break;
-            case 4: rotationSpeed = 0.12f; break;
-            case 5: rotationSpeed = 0.09f; break;
-            case 6: rotationSpeed = 0.06f; break;
-            case 7: rotationSpeed = 0.03f; break;
-            default: rotationSpeed = 0.0f; break;
-            }
-
-            //float rotationSpeed = 0.0f * (i + 1); // 0 predkosc obrotu dla wygodniejszego widoku
-
-            model = glm::rotate(model, (float)glfwGetTime() * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
-
-            // Odleglosc planet od slonca
-            float distanceFromSun;
-            switch (i) {
-            case 0: distanceFromSun = 3.871f * 0.5f; break;
-            case 1: distanceFromSun = 7.233f * 0.45f; break;
-            case 2: distanceFromSun = 10.0f * 0.4f; break;
-            case 3: distanceFromSun = 15.237f * 0.35f; break;
-            case 4: distanceFromSun = 26.034f * 0.30f; break;
-            case 5: distanceFromSun = 37.371f * 0.25f; break;
-            case 6: distanceFromSun = 45.913f * 0.25f; break;
-            case 7: distanceFromSun = 54.0f * 0.25f; break;
-            default: distanceFromSun = 0.0f; break;
-            }
-            model = glm::translate(model, glm::vec3(distanceFromSun, 0.0f, 0.0f));
-
-            // Rozmiar planet
-            float planetSize;
-            switch (i) {
-            case 0: planetSize = 0.038f; break;
-            case 1: planetSize = 0.09f; break;
-            case 2: planetSize = 0.10f; break;
-            case 3: planetSize = 0.05f; break;
-            case 4: planetSize = 0.6f; break;
-            case 5: planetSize = 0.45f; break;
-            case 6: planetSize = 0.2f; break;
-            case 7: planetSize = 0.19f; break;
-            default: planetSize = 0.0f; break;
-            }
-            // Zmiana rozmiaru dla kazdej planety
-            model = glm::scale(model, glm::vec3(planetSize));
-
-            // Obrot planety wokol wlasnej osi
-            float planetSpinSpeed = 1.0 * 2/(i + 1);
-
-            model = glm::rotate(model, (float)glfwGetTime() * planetSpinSpeed, glm::vec3(0.1f, 1.0f, 0.1f));
-
-            // Model matrix in shader
-            shader.setMat4("model", model);
-
-            // Bind tekstury
-            planetTextures[i].bind();
-
-            // Render planety
-            planets[i].draw(shader);
-
-            // Render Saturn's ring
-            if (i == 5) { // Saturn is the sixth planet (index 5)
-                glm::mat4 ringModel = glm::mat4(1.0f);
-                ringModel = glm::translate(ringModel, glm::vec3(distanceFromSun, 0.0f, 0.0f));
-                ringModel = glm::scale(ringModel, glm::vec3(planetSize));
-                ringModel = glm::rotate(ringModel, (float)glfwGetTime() * planetSpinSpeed, glm::vec3(0.1f, 0.1f, 0.1f)); // Use the same rotation speed as the planet
-                ringTexture.bind();
-                saturnRing.drawRing(shader);
-            }
-        }
-
-
-        // Disable depth testing after rendering planets
-        glDisable(GL_DEPTH_TEST);
-
-        // Swap buffers and poll events
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
-
-    // Clean up resources
-    glDeleteVertexArrays(1, &backgroundVAO);
-    glDeleteBuffers(1, &backgroundVBO);
-    glfwTerminate();
-    return 0;
-}
-
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
-}
-
-void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
-    if (firstMouse) {
-        lastX = xpos;
-        lastY = ypos;
-        firstMouse = false;
-    }
-
-    float xoffset = xpos - lastX;
-    float yoffset = lastY - ypos;
-    lastX = xpos;
-    lastY = ypos;
-
-    camera.ProcessMouseMovement(xoffset, yoffset);
-}
-
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
-    camera.ProcessMouseScroll(yoffset);
-}
-
-void processInput(GLFWwindow* window) {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        camera.ProcessKeyboard(FORWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        camera.ProcessKeyboard(BACKWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        camera.ProcessKeyboard(LEFT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        camera.ProcessKeyboard(RIGHT, deltaTime);
-}
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <memory>
+#include "Shader.h"
+#include "Camera.h"
+#include "Object.h"
+#include "Texture.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "TexturePack.h"
+#include "ThreadPool.h"
+#include "MeshArena.h"
+#include "ProceduralSphere.h"
+#include "SphereImpostor.h"
+#include "AnalyticRing.h"
+#include "PlanetTerrain.h"
+#include "OrbitLines.h"
+#include "StreamBuffer.h"
+#include "RenderQueue.h"
+#include "TextureArray.h"
+#include "BodyInstances.h"
+#include "IndirectBatch.h"
+#include "FrustumCuller.h"
+#include "Occlusion.h"
+#include "VirtualTexture.h"
+#include "Skybox.h"
+#define NUM_LIGHTS 6
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// Wielkosc okna
+const unsigned int SCR_WIDTH = 1200;
+const unsigned int SCR_HEIGHT = 900;
+
+// Najwieksza wysokosc terenu planet, w promieniach planety
+const float TERRAIN_AMPLITUDE = 0.02f;
+
+// Okluder jest mniejszy od kuli, bo wielokaty siatki leza wewnatrz sfery
+const float OCCLUDER_SCALE = 0.85f;
+
+// Limit pamieci tekstur wczytywanych w tle (bajty), mniejsze wezly renderujace
+const size_t TEXTURE_BUDGET = 128u << 20;
+
+// Kamera
+Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+// Kule planet generowane w shaderze (P przełącza na siatki z MeshArena)
+bool proceduralSpheres = true;
+
+// Odległe ciała jako impostory śledzone promieniem (I przełącza)
+bool impostors = true;
+
+// Orbity planet (O przełącza)
+bool showOrbits = true;
+
+// Statystyki odrzucania, zasloniecia i tekstur wypisywane raz po nacisnieciu T, nie w kazdej klatce
+bool printStats = false;
+
+// Czas
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// Funkcje
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void processInput(GLFWwindow* window);
+void setSceneUniforms(Shader& shader, const glm::mat4& projection, const glm::mat4& view, const glm::vec3* lightPositions);
+
+int main() {
+    //GLFW
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    // Tworzenie okna
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Projekt - Uklad sloneczny", NULL, NULL);
+    if (window == NULL) {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    //GLAD
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    StreamBuffer::loadExtensions((GLADloadproc)glfwGetProcAddress);
+    IndirectBatch::loadExtensions((GLADloadproc)glfwGetProcAddress);
+    CompressedTexture::loadExtensions();
+
+    glEnable(GL_DEPTH_TEST);
+
+    // shader tła: skybox z cube mapy, jeden trojkat na caly ekran
+    Shader backgroundShader("background_vertex_shader.glsl", "background_fragment_shader.glsl");
+    // Filtrowanie cube mapy przez krawedzie scian
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+    // shadery
+    Shader shader("vertex_shader.glsl", "fragment_shader.glsl", "#define INSTANCED\n");
+    Shader sphereShader("sphere_vertex_shader.glsl", "fragment_shader.glsl", "#define INSTANCED\n");
+    Shader impostorShader("impostor_vertex_shader.glsl", "fragment_shader.glsl", "#define IMPOSTOR\n");
+    Shader ringShader("ring_vertex_shader.glsl", "ring_fragment_shader.glsl");
+    Shader orbitShader("orbit_vertex_shader.glsl", "orbit_fragment_shader.glsl");
+    Shader occlusionShader("occlusion_vertex_shader.glsl", "occlusion_fragment_shader.glsl");
+    Shader feedbackShader("vertex_shader.glsl", "feedback_fragment_shader.glsl", "#define INSTANCED\n");
+
+    // Watki robocze, cache siatek i wspolny bufor wszystkich siatek
+    ThreadPool workers;
+    MeshCache meshCache("cache");
+    MeshArena meshArena;
+
+    // Dane wysylane w trakcie petli (fragmenty terenu, orbity) ida przez bufor pierscieniowy
+    StreamBuffer streamBuffer(2 << 20);
+    std::cout << "Stream buffer: " << (streamBuffer.persistent() ? "persistent mapping" : "orphaning fallback") << std::endl;
+    meshArena.setStaging(&streamBuffer);
+    SphereImpostor sphereImpostor;
+    OrbitLines orbitLines;
+    orbitLines.setStaging(&streamBuffer);
+    RenderQueue renderQueue(100.0f);
+
+    // Tekstury dekodowane w watkach roboczych i przesylane porcjami co klatke; do tego czasu szary zastepnik
+    // Kazda sciezka wczytywana raz, wspoldzielona przez uchwyty z pamieci podrecznej
+    // Wszystkie tekstury z jednego zmapowanego pliku (tools/texpack), jesli istnieje
+    TexturePack texturePack;
+    TextureLoader textureLoader(workers, streamBuffer);
+    textureLoader.setBudget(TEXTURE_BUDGET);
+    if (std::ifstream("textures/textures.gkpk").good()) {
+        if (texturePack.open("textures/textures.gkpk")) {
+            textureLoader.setPack(&texturePack);
+            std::cout << "Texture pack: " << texturePack.size() << " files" << std::endl;
+        }
+        else {
+            std::cerr << "ERROR::TEXTUREPACK::INVALID textures/textures.gkpk" << std::endl;
+        }
+    }
+    TextureCache textureCache(&textureLoader);
+    // Tlo: bg.bmp (equirectangular) przeliczane raz w watkach roboczych na cube mape, sciana nie gestsza niz ekran
+    // i cala cube mapa najwyzej pol budzetu tekstur, w ktorym jest liczona
+    Skybox skybox(streamBuffer);
+    skybox.load("textures/bg.bmp", workers, Skybox::faceSizeFor(SCR_HEIGHT, camera.Zoom, TEXTURE_BUDGET / 2),
+        texturePack.isOpen() ? &texturePack : nullptr);
+    size_t skyReserved = 0;
+    // Slonce i gazowe olbrzymy bez tekstur: powierzchnia liczona w fragment_shader.glsl (1 slonce, 2..5 Jowisz..Neptun),
+    // wiec nie ma dla nich odczytu z dysku ani pamieci tekstur, a szczegoly rosna z przyblizeniem
+    const int bodySurfaces[9] = { 1, 0, 0, 0, 0, 2, 3, 4, 5 };
+    const char* bodyTexturePaths[9] = { nullptr, "textures/mercury.bmp", "textures/venus.bmp", "textures/earth.bmp", "textures/mars.bmp",
+        nullptr, nullptr, nullptr, nullptr };
+
+    // Wczytywanie modeli planet
+    Object sun(meshArena, &meshCache);
+
+    // Definicja planet
+    Object planets[8] = {
+    Object(meshArena, &meshCache), Object(meshArena, &meshCache), Object(meshArena, &meshCache), Object(meshArena, &meshCache),
+    Object(meshArena, &meshCache), Object(meshArena, &meshCache), Object(meshArena, &meshCache), Object(meshArena, &meshCache)
+    };
+    for (int i = 0; i < 8; ++i) {
+        planets[i].loadModel("textures/planet.obj", &workers, &meshCache);
+    }
+
+    // Saturn ring
+    AnalyticRing saturnRing(1.2f, 2.0f);
+    TextureCache::Handle ringTexture = textureCache.acquire("textures/saturn_ring.bmp");
+
+    // Ciała w kolejności rysowania: słońce i planety
+    TextureCache::Handle bodyTextures[9];
+    Object* bodyObjects[9] = { &sun };
+    for (int i = 0; i < 8; ++i)
+        bodyObjects[i + 1] = &planets[i];
+    for (int b = 0; b < 9; ++b)
+        if (!bodySurfaces[b])
+            bodyTextures[b] = textureCache.acquire(bodyTexturePaths[b]);
+    bool texturesReported = false;
+
+    // Tekstury ciał z teksturą w jednej tablicy (kolejne warstwy) do rysowania instancjonowanego
+    int bodyLayers[9];
+    int bodyLayerCount = 0;
+    for (int b = 0; b < 9; ++b)
+        bodyLayers[b] = bodySurfaces[b] ? 0 : bodyLayerCount++;
+    TextureArray bodyTextureArray(bodyLayerCount, 2048, 1024);
+    for (int b = 0; b < 9; ++b)
+        if (!bodySurfaces[b])
+            textureLoader.loadLayer(bodyTextureArray, bodyLayers[b], bodyTexturePaths[b]);
+    BodyInstances bodyInstances(streamBuffer);
+    IndirectBatch indirectBatch;
+    FrustumCuller bodyCuller;
+    SphereOccluders occluders;
+    OcclusionQueries occlusionQueries(10);
+
+    // Mapy Ziemi i Marsa w pelnej rozdzielczosci jako tekstury wirtualne, gdy sa pliki stron z tools/vttile.
+    // Instancje tych cial maja warstwe -1 / -2 zamiast indeksu w tablicy tekstur.
+    VirtualTexture earthVirtual(workers, streamBuffer, 1), marsVirtual(workers, streamBuffer, 3);
+    VirtualTexture* virtualTextures[2] = { &earthVirtual, &marsVirtual };
+    const int virtualBodies[2] = { 3, 4 };
+    const char* virtualPaths[2] = { "textures/earth.gkvt", "textures/mars.gkvt" };
+    int bodyVirtual[9] = { -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+    for (int v = 0; v < 2; ++v) {
+        if (std::ifstream(virtualPaths[v]).good() && virtualTextures[v]->open(virtualPaths[v])) {
+            bodyVirtual[virtualBodies[v]] = v;
+            std::cout << "Virtual texture " << virtualPaths[v] << ": " << virtualTextures[v]->width() << "x" << virtualTextures[v]->height()
+                      << ", " << virtualTextures[v]->levelCount() << " levels" << std::endl;
+        }
+        // Samplery zawsze na osobnych jednostkach, nawet bez pliku
+        for (Shader* program : { &shader, &sphereShader }) {
+            program->use();
+            virtualTextures[v]->bind(*program, v);
+        }
+        // Tablica stron i cache zajmuja stala pamiec, liczona w budzecie tekstur
+        textureLoader.reserve(virtualTextures[v]->storageBytes());
+    }
+    VirtualTextureFeedback virtualFeedback(SCR_WIDTH, SCR_HEIGHT);
+    std::cout << "Mesh draws: " << (IndirectBatch::multiDrawSupported() ? "multi-draw indirect" : "instanced fallback loop") << std::endl;
+
+    // Teren planet skalistych (Merkury..Mars) do zblizen, fragmenty liczone w watkach roboczych
+    std::unique_ptr<PlanetTerrain> bodyTerrains[9];
+    for (int b = 1; b <= 4; ++b)
+        bodyTerrains[b].reset(new PlanetTerrain(meshArena, &workers, TerrainHeight{ (unsigned int)b, TERRAIN_AMPLITUDE, 10 }));
+
+    // Główna pętla renderująca
+    while (!glfwWindowShouldClose(window)) {
+        // Czas pomiędzy klatkami
+        float currentFrame = glfwGetTime();
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // Obsługa wejścia
+        processInput(window);
+
+        // Kolejne porcje tekstur
+        textureLoader.update();
+        skybox.update();
+        if (skybox.storageBytes() != skyReserved) {
+            textureLoader.unreserve(skyReserved);
+            skyReserved = skybox.storageBytes();
+            textureLoader.reserve(skyReserved);
+        }
+        if (!texturesReported && textureLoader.idle()) {
+            const TextureCacheStats& textureStats = textureCache.statistics();
+            std::cout << "Textures: " << textureStats.loads << " loaded, " << textureStats.hits << "/" << textureStats.requests << " cache hits" << std::endl;
+            texturesReported = true;
+        }
+
+        // Kafle tekstur wirtualnych wskazane przez informacje zwrotna z poprzednich klatek
+        virtualFeedback.collect(virtualTextures, 2);
+        for (int v = 0; v < 2; ++v)
+            virtualTextures[v]->update();
+
+        // Renderowanie
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); 
+
+        // Enable depth testing
+        glEnable(GL_DEPTH_TEST);
+
+
+        glm::vec3 lightPositions[NUM_LIGHTS] = { 
+            glm::vec3(2.0f, 0.0f, 0.0f),  // right
+            glm::vec3(-2.0f, 0.0f, 0.0f), // left 
+            glm::vec3(0.0f, 2.0f, 0.0f),  // above 
+            glm::vec3(0.0f, -2.0f, 0.0f), // below 
+            glm::vec3(0.0f, 0.0f, 2.0f),  // in front
+            glm::vec3(0.0f, 0.0f, -2.0f)  // behind 
+        };
+        
+        // Macierze i rozmiary ciał: 0 = słońce, 1..8 = planety
+        glm::mat4 bodyModels[9];
+        float bodyRadii[9];
+        bodyModels[0] = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f)); // Sun is bigger
+        bodyRadii[0] = 1.0f;
+
+        for (int i = 0; i < 8; ++i) {
+            // Nowy matrix dla kazdej planety
+            glm::mat4 model = glm::mat4(1.0f);
+
+            // Rotacja planet
+            //float rotationSpeed = 0.015f * (i + 1); // Predkosc rotacji planet wokol slonca
+            //float rotationSpeed = 0.0f;
+
+            float rotationSpeed;
+            switch (i) {
+            case 0: rotationSpeed = 0.24f; break;
+            case 1: rotationSpeed = 0.21f; break;
+            case 2: rotationSpeed = 0.18f; break;
+            case 3: rotationSpeed = 0.15f; break;
+            case 4: rotationSpeed = 0.12f; break;
+            case 5: rotationSpeed = 0.09f; break;
+            case 6: rotationSpeed = 0.06f; break;
+            case 7: rotationSpeed = 0.03f; break;
+            default: rotationSpeed = 0.0f; break;
+            }
+
+            //float rotationSpeed = 0.0f * (i + 1); // 0 predkosc obrotu dla wygodniejszego widoku
+
+            model = glm::rotate(model, (float)glfwGetTime() * rotationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
+
+            // Odleglosc planet od slonca
+            float distanceFromSun;
+            switch (i) {
+            case 0: distanceFromSun = 3.871f * 0.5f; break;
+            case 1: distanceFromSun = 7.233f * 0.45f; break;
+            case 2: distanceFromSun = 10.0f * 0.4f; break;
+            case 3: distanceFromSun = 15.237f * 0.35f; break;
+            case 4: distanceFromSun = 26.034f * 0.30f; break;
+            case 5: distanceFromSun = 37.371f * 0.25f; break;
+            case 6: distanceFromSun = 45.913f * 0.25f; break;
+            case 7: distanceFromSun = 54.0f * 0.25f; break;
+            default: distanceFromSun = 0.0f; break;
+            }
+            model = glm::translate(model, glm::vec3(distanceFromSun, 0.0f, 0.0f));
+
+            // Orbita planety, wysylana do GPU tylko gdy sie zmieni
+            Orbit orbit;
+            orbit.semiMajorAxis = distanceFromSun;
+            orbit.angularSpeed = rotationSpeed;
+            orbit.color = glm::vec4(0.6f, 0.7f, 0.9f, 0.5f);
+            orbitLines.set(i, orbit);
+
+            // Rozmiar planet
+            float planetSize;
+            switch (i) {
+            case 0: planetSize = 0.038f; break;
+            case 1: planetSize = 0.09f; break;
+            case 2: planetSize = 0.10f; break;
+            case 3: planetSize = 0.05f; break;
+            case 4: planetSize = 0.6f; break;
+            case 5: planetSize = 0.45f; break;
+            case 6: planetSize = 0.2f; break;
+            case 7: planetSize = 0.19f; break;
+            default: planetSize = 0.0f; break;
+            }
+            // Zmiana rozmiaru dla kazdej planety
+            model = glm::scale(model, glm::vec3(planetSize));
+
+            // Obrot planety wokol wlasnej osi
+            float planetSpinSpeed = 1.0 * 2/(i + 1);
+
+            model = glm::rotate(model, (float)glfwGetTime() * planetSpinSpeed, glm::vec3(0.1f, 1.0f, 0.1f));
+
+            bodyModels[i + 1] = model;
+            bodyRadii[i + 1] = planetSize;
+        }
+
+        // Bliska plaszczyzna odcinania przesuwa sie za kamera przy zblizeniu do powierzchni
+        float nearPlane = 0.1f;
+        for (int b = 0; b < 9; ++b) {
+            float surfaceDistance = glm::length(camera.Position - glm::vec3(bodyModels[b][3])) - bodyRadii[b] * (1.0f + TERRAIN_AMPLITUDE);
+            nearPlane = glm::clamp(surfaceDistance * 0.5f, 0.0005f, nearPlane);
+        }
+
+        // Matryce przekształceń
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, nearPlane, 100.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+
+        // Odrzucanie ciał poza ostrosłupem widzenia; kula 9 obejmuje pierścień Saturna
+        glm::vec3 boundCenters[10];
+        float boundRadii[10];
+        for (int b = 0; b < 9; ++b) {
+            boundCenters[b] = glm::vec3(bodyModels[b][3]);
+            boundRadii[b] = bodyRadii[b] * (1.0f + TERRAIN_AMPLITUDE);
+        }
+        boundCenters[9] = boundCenters[6];
+        boundRadii[9] = bodyRadii[6] * saturnRing.extent();
+        bodyCuller.clear();
+        for (int b = 0; b < 10; ++b)
+            bodyCuller.add(boundCenters[b], boundRadii[b]);
+        bodyCuller.setFrustum(projection * view);
+        bool inFrustum[10] = {};
+        for (unsigned int index : bodyCuller.cull(&workers))
+            inFrustum[index] = true;
+
+        // Zasloniecie: ciala za sloncem i gazowymi olbrzymami (CPU), teren wg zapytan z poprzedniej klatki
+        occlusionQueries.beginFrame();
+        occluders.clear();
+        for (int b = 0; b < 9; ++b)
+            if (inFrustum[b] && (b == 0 || b >= 5))
+                occluders.add(boundCenters[b], bodyRadii[b] * OCCLUDER_SCALE);
+        bool visible[10] = {};
+        unsigned int hiddenCount = 0;
+        for (int b = 0; b < 10; ++b) {
+            if (!inFrustum[b])
+                continue;
+            bool queryHidden = b < 9 && bodyTerrains[b] && occlusionQueries.occluded(b);
+            visible[b] = !queryHidden && !occluders.occluded(camera.Position, boundCenters[b], boundRadii[b]);
+            hiddenCount += visible[b] ? 0 : 1;
+        }
+
+        // Statystyki na zadanie (T)
+        if (printStats) {
+            const CullStats& cullStats = bodyCuller.lastStats();
+            std::cout << "Culling: " << cullStats.visible << "/" << cullStats.tested << " visible, " << cullStats.milliseconds << " ms" << std::endl;
+            std::cout << "Occlusion: " << hiddenCount << " hidden" << std::endl;
+            const TextureBudgetStats& budgetStats = textureLoader.budgetStatistics();
+            std::cout << "Texture budget: " << (budgetStats.residentBytes >> 20) << "/" << (budgetStats.budget >> 20) << " MB (" << (budgetStats.reservedBytes >> 20) << " MB fixed), peak " << (budgetStats.peakBytes >> 20)
+                      << " MB, " << budgetStats.droppedLevels << " levels dropped, " << budgetStats.evictions << " evictions, " << budgetStats.reloads << " reloads, "
+                      << budgetStats.deniedFrames << " frames over budget" << std::endl;
+            for (int v = 0; v < 2; ++v) {
+                if (bodyVirtual[virtualBodies[v]] < 0)
+                    continue;
+                const VirtualTextureStats& virtualStats = virtualTextures[v]->statistics();
+                std::cout << "Virtual texture " << virtualPaths[v] << ": " << virtualStats.resident << " tiles resident, " << virtualStats.uploads << " uploads, "
+                          << virtualStats.evictions << " evictions, " << virtualStats.dropped << " dropped" << std::endl;
+            }
+            printStats = false;
+        }
+
+        // Bliskie ciała jako kule, odległe jako impostory
+        float projectedRadii[9];
+        bool asImpostor[9];
+        for (int b = 0; b < 9; ++b) {
+            projectedRadii[b] = camera.ProjectedRadius(glm::vec3(bodyModels[b][3]), bodyRadii[b], (float)SCR_HEIGHT);
+            asImpostor[b] = impostors && projectedRadii[b] < IMPOSTOR_MAX_RADIUS;
+        }
+
+        // Mipmapy tekstur doczytywane do rozmiaru na ekranie: obwod kuli w pikselach na szerokosc tekstury
+        for (int b = 0; b < 9; ++b) {
+            if (!visible[b] || bodySurfaces[b])
+                continue;
+            float texels = 2.0f * glm::pi<float>() * projectedRadii[b];
+            if (asImpostor[b])
+                textureLoader.request(*bodyTextures[b], texels);
+            else if (bodyVirtual[b] < 0)
+                textureLoader.request(bodyTextureArray, texels);
+        }
+        if (visible[9])
+            textureLoader.request(*ringTexture, projectedRadii[6] * saturnRing.extent()); // u biegnie od wewnetrznej do zewnetrznej krawedzi
+
+        // Teren zamiast kuli, gdy planeta zajmuje duza czesc ekranu
+        float projectionScale = (float)SCR_HEIGHT / (2.0f * tan(glm::radians(camera.Zoom) * 0.5f));
+        bool asTerrain[9] = {};
+        for (int b = 0; b < 9; ++b) {
+            if (!bodyTerrains[b] || !visible[b])
+                continue;
+            if (projectedRadii[b] < TERRAIN_MIN_RADIUS) {
+                bodyTerrains[b]->collapse();
+                continue;
+            }
+            glm::vec3 localCamera = glm::vec3(glm::inverse(bodyModels[b]) * glm::vec4(camera.Position, 1.0f));
+            bodyTerrains[b]->update(localCamera, projectionScale);
+            asTerrain[b] = bodyTerrains[b]->ready();
+        }
+
+        // Wspolne uniformy sceny, raz na klatke dla kazdego programu
+        Shader* scenePrograms[] = { &shader, &sphereShader, &impostorShader, &ringShader, &orbitShader };
+        for (Shader* program : scenePrograms) {
+            program->use();
+            setSceneUniforms(*program, projection, view, lightPositions);
+        }
+        ringShader.setVec3("sunPos", glm::vec3(bodyModels[0][3]));
+
+        // Kolejka rysowania: pakiety sortowane wg stanu i glebi, bez zbednych zmian stanu
+        std::map<int, std::vector<BodyInstance>> instanceGroups;
+        std::map<int, float> instanceGroupDepths;
+        std::map<int, MeshHandle> instanceGroupMeshes;
+        indirectBatch.clear();
+        float indirectDepth = 0.0f;
+        for (int b = 0; b < 9; ++b) {
+            if (!visible[b])
+                continue;
+            glm::mat4 model = bodyModels[b];
+            float depth = glm::length(glm::vec3(model[3]) - camera.Position);
+            bool isSun = b == 0;
+            float layer = bodyVirtual[b] >= 0 ? -1.0f - bodyVirtual[b] : (float)bodyLayers[b];
+            int surface = bodySurfaces[b];
+            unsigned int texture = surface ? 0 : bodyTextures[b]->ID;
+            if (asTerrain[b]) {
+                // Fragmenty terenu leza we wspolnym buforze siatek, wszystkie z instancja planety
+                unsigned int instance = indirectBatch.addInstance(BodyInstance{ model, layer, isSun, surface });
+                bodyTerrains[b]->collect(indirectBatch, instance);
+                indirectDepth = indirectBatch.instanceCount() == 1 ? depth : std::min(indirectDepth, depth);
+            }
+            else if (asImpostor[b]) {
+                // Impostor: jeden czworokąt na ciało
+                renderQueue.submit(impostorShader, sphereImpostor.vertexArray(), texture, depth, false, [=, &sphereImpostor](Shader& program) {
+                    program.setBool("isSun", isSun);
+                    program.setInt("proceduralSurface", surface);
+                    program.setMat4("model", model);
+                    sphereImpostor.draw();
+                });
+            }
+            else {
+                // Kule: grupy ciał o tej samej siatce (albo podziale kuli z gl_VertexID) rysowane jednym wywołaniem
+                BodyInstance instance = { model, layer, isSun, surface };
+                int group = proceduralSpheres ? (int)ProceduralSphere::segmentsFor(projectedRadii[b]) : bodyObjects[b]->meshHandle().id;
+                std::vector<BodyInstance>& instances = instanceGroups[group];
+                instances.push_back(instance);
+                float& groupDepth = instanceGroupDepths[group];
+                groupDepth = instances.size() == 1 ? depth : std::min(groupDepth, depth);
+                instanceGroupMeshes[group] = bodyObjects[b]->meshHandle();
+            }
+        }
+        for (std::map<int, std::vector<BodyInstance>>::iterator group = instanceGroups.begin(); group != instanceGroups.end(); ++group) {
+            const std::vector<BodyInstance>* instances = &group->second;
+            if (proceduralSpheres) {
+                unsigned int segments = (unsigned int)group->first;
+                renderQueue.submit(sphereShader, bodyInstances.proceduralVertexArray(), bodyTextureArray.ID, instanceGroupDepths[group->first], false, [=, &bodyInstances](Shader& program) {
+                    bodyInstances.drawProcedural(program, segments, segments / 2, *instances);
+                }, GL_TEXTURE_2D_ARRAY);
+            }
+            else {
+                // Ciala z ta sama siatka jako kolejne instancje jednej komendy
+                unsigned int first = (unsigned int)indirectBatch.instanceCount();
+                for (const BodyInstance& instance : *instances)
+                    indirectBatch.addInstance(instance);
+                indirectBatch.addDraw(instanceGroupMeshes[group->first], first, (unsigned int)instances->size());
+                float groupDepth = instanceGroupDepths[group->first];
+                indirectDepth = first == 0 ? groupDepth : std::min(indirectDepth, groupDepth);
+            }
+        }
+        // Siatki cial i teren: jedna lista komend, jedno glMultiDrawElementsIndirect
+        if (indirectBatch.drawCount() > 0) {
+            renderQueue.submit(shader, bodyInstances.meshVertexArray(), bodyTextureArray.ID, indirectDepth, false, [&](Shader&) {
+                indirectBatch.draw(bodyInstances, meshArena, streamBuffer);
+            }, GL_TEXTURE_2D_ARRAY);
+        }
+
+        // Tlo na dalekiej plaszczyznie (LEQUAL, bez zapisu glebi), wiec zasloniete piksele nie sa cieniowane.
+        // Z zarezerwowana glebia za wszystkimi pakietami rysuje sie po brylach, a zawsze przed orbitami i pierscieniem.
+        // Promienie widoku odtwarzane w shaderze, wiec niebo obraca sie z kamera bez paralaksy.
+        if (skybox.ready()) {
+            glm::mat4 inverseViewProjection = Skybox::inverseViewProjection(projection, view);
+            renderQueue.submit(backgroundShader, skybox.vertexArray(), skybox.cubeMap(), RenderQueue::BACKGROUND_DEPTH, true, [=, &skybox](Shader& program) {
+                program.setMat4("inverseViewProjection", inverseViewProjection);
+                glDepthFunc(GL_LEQUAL);
+                skybox.draw();
+                glDepthFunc(GL_LESS);
+            }, GL_TEXTURE_CUBE_MAP);
+        }
+
+        // Orbity: jedno wywolanie instancjonowane, przezroczyste
+        if (showOrbits) {
+            float time = (float)glfwGetTime();
+            renderQueue.submit(orbitShader, orbitLines.vertexArray(), 0, glm::length(camera.Position), true, [=, &orbitLines](Shader& program) {
+                orbitLines.draw(program, time, projectionScale);
+            });
+        }
+
+        // Saturn's ring (Saturn is the sixth planet, body 6), blended over the spheres
+        glm::mat4 saturnModel = bodyModels[6];
+        if (visible[9]) {
+            renderQueue.submit(ringShader, saturnRing.vertexArray(), ringTexture->ID, glm::length(glm::vec3(saturnModel[3]) - camera.Position), true, [=, &saturnRing, &occlusionQueries](Shader& program) {
+                // Pominiety przez GPU, jesli zapytanie z poprzedniej klatki nie przepuscilo probek
+                bool conditional = occlusionQueries.beginConditional(9);
+                saturnRing.draw(program, saturnModel);
+                if (conditional)
+                    occlusionQueries.endConditional();
+            });
+        }
+
+        renderQueue.flush();
+
+        // Zapytania o zasloniecie dla nastepnej klatki, na glebi nieprzezroczystej geometrii
+        occlusionQueries.beginProxies(occlusionShader, projection * view);
+        for (int b = 1; b < 9; ++b)
+            if (bodyTerrains[b] && inFrustum[b] && projectedRadii[b] >= TERRAIN_MIN_RADIUS)
+                occlusionQueries.issue(b, camera.Position, nearPlane, boundCenters[b], boundRadii[b]);
+        if (inFrustum[9])
+            occlusionQueries.issue(9, camera.Position, nearPlane, boundCenters[9], boundRadii[9]);
+        occlusionQueries.endProxies();
+
+        // Informacja zwrotna tekstur wirtualnych: kafle potrzebne w tej klatce, w malej rozdzielczosci
+        if (bodyVirtual[virtualBodies[0]] >= 0 || bodyVirtual[virtualBodies[1]] >= 0) {
+            virtualFeedback.begin(feedbackShader);
+            feedbackShader.setMat4("projection", projection);
+            feedbackShader.setMat4("view", view);
+            glBindVertexArray(bodyInstances.meshVertexArray());
+            for (int v = 0; v < 2; ++v) {
+                int b = virtualBodies[v];
+                if (bodyVirtual[b] < 0 || !visible[b] || asImpostor[b])
+                    continue;
+                virtualTextures[v]->bindFeedback(feedbackShader, v);
+                std::vector<BodyInstance> feedbackInstance(1, BodyInstance{ bodyModels[b], -1.0f - v, false, 0 });
+                bodyInstances.drawMesh(meshArena, bodyObjects[b]->meshHandle(), feedbackInstance);
+            }
+            glBindVertexArray(0);
+            virtualFeedback.end();
+        }
+
+        // Disable depth testing after rendering planets
+        glDisable(GL_DEPTH_TEST);
+
+        // Zamkniecie regionu tej klatki w buforze strumieniowym
+        streamBuffer.endFrame();
+
+        // Swap buffers and poll events
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    // Clean up resources
+    skybox.destroy();
+    for (int b = 0; b < 9; ++b) {
+        if (bodyTerrains[b])
+            bodyTerrains[b]->destroy();
+        bodyTerrains[b].reset();
+    }
+    meshArena.destroy();
+    textureLoader.destroy();
+    ringTexture.reset();
+    for (TextureCache::Handle& texture : bodyTextures)
+        texture.reset();
+    textureCache.clear();
+    for (VirtualTexture* virtualTexture : virtualTextures)
+        virtualTexture->destroy();
+    virtualFeedback.destroy();
+    streamBuffer.destroy();
+    sphereImpostor.destroy();
+    saturnRing.destroy();
+    orbitLines.destroy();
+    occlusionQueries.destroy();
+    bodyInstances.destroy();
+    glfwTerminate();
+    return 0;
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    glViewport(0, 0, width, height);
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
+    if (firstMouse) {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos;
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+    camera.ProcessMouseScroll(yoffset);
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (action != GLFW_PRESS)
+        return;
+
+    if (key == GLFW_KEY_P)
+        proceduralSpheres = !proceduralSpheres;
+    if (key == GLFW_KEY_I)
+        impostors = !impostors;
+    if (key == GLFW_KEY_O)
+        showOrbits = !showOrbits;
+    if (key == GLFW_KEY_T)
+        printStats = true;
+}
+
+// Swiatla, pozycja kamery i macierze wspolne dla shaderow sceny
+void setSceneUniforms(Shader& shader, const glm::mat4& projection, const glm::mat4& view, const glm::vec3* lightPositions) {
+    for (unsigned int i = 0; i < NUM_LIGHTS; i++)
+    {
+        std::string lightPosName = "lightPos[" + std::to_string(i) + "]";
+        shader.setVec3(lightPosName, lightPositions[i]);
+    }
+    shader.setVec3("viewPos", camera.Position);
+    shader.setMat4("projection", projection);
+    shader.setMat4("view", view);
+}
+
+void processInput(GLFWwindow* window) {
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+}
@@ -0,0 +1,154 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+// glad.h may already have defined APIENTRY as __stdcall, minwindef.h redefines it as WINAPI (C4005)
+#ifdef APIENTRY
+#undef APIENTRY
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() : base(nullptr), length(0) {
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) : base(other.base), length(other.length) {
+        other.base = nullptr;
+        other.length = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other) {
+        if (this != &other) {
+            close();
+            base = other.base;
+            length = other.length;
+            other.base = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    // Map the file, returns false if it does not exist or is empty
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+        base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!base)
+            return false;
+        length = (size_t)fileSize.QuadPart;
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            return false;
+        struct stat info;
+        if (fstat(file, &info) != 0 || info.st_size == 0) {
+            ::close(file);
+            return false;
+        }
+        void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if (view == MAP_FAILED)
+            return false;
+        base = view;
+        length = (size_t)info.st_size;
+#endif
+        return true;
+    }
+
+    void close() {
+        if (!base)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        munmap(base, length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    bool isOpen() const {
+        return base != nullptr;
+    }
+
+    enum Advice {
+        WILL_NEED, // start reading the range in ahead of use
+        DONT_NEED, // the range may leave memory, it is read again from the file if touched
+        RANDOM     // no read-ahead around faults in the range
+    };
+
+    // Paging hint for a byte range of the mapping (madvise; prefetch and working set trim on Windows)
+    void advise(size_t offset, size_t size, Advice advice) const {
+        if (!base || offset >= length)
+            return;
+        size = std::min(size, length - offset);
+#ifdef _WIN32
+        if (advice == WILL_NEED) {
+            WIN32_MEMORY_RANGE_ENTRY range = { (unsigned char*)base + offset, size };
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+        }
+        else if (advice == DONT_NEED) {
+            // Unlocking pages that are not locked removes them from the working set
+            VirtualUnlock((unsigned char*)base + offset, size);
+        }
+#else
+        // madvise wants a page-aligned start
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t start = offset / page * page;
+        int flag = advice == WILL_NEED ? MADV_WILLNEED : advice == DONT_NEED ? MADV_DONTNEED : MADV_RANDOM;
+        madvise((unsigned char*)base + start, size + offset - start, flag);
+#endif
+    }
+
+    const unsigned char* data() const {
+        return (const unsigned char*)base;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    void* base;
+    size_t length;
+};
+
+#endif
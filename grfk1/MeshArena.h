@@ -0,0 +1,292 @@
+#ifndef MESHARENA_H
+#define MESHARENA_H
+
+#include <glad/glad.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <iostream>
+#include "StreamBuffer.h"
+
+// Mesh stored in a MeshArena, referenced by element offsets into the shared buffers
+struct MeshHandle {
+    int id = -1;
+    GLint baseVertex = 0;
+    unsigned int vertexCount = 0;
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+
+    bool valid() const {
+        return id >= 0;
+    }
+};
+
+// First-fit free list over [0, capacity) with coalescing of neighbouring blocks
+class RangeAllocator {
+public:
+    static const size_t INVALID = (size_t)-1;
+
+    explicit RangeAllocator(size_t capacity = 0) : total(0), used(0) {
+        grow(capacity);
+    }
+
+    size_t allocate(size_t size) {
+        for (std::map<size_t, size_t>::iterator it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+            if (it->second < size)
+                continue;
+            size_t offset = it->first;
+            size_t remaining = it->second - size;
+            freeBlocks.erase(it);
+            if (remaining > 0)
+                freeBlocks[offset + size] = remaining;
+            used += size;
+            return offset;
+        }
+        return INVALID;
+    }
+
+    void free(size_t offset, size_t size) {
+        if (size == 0)
+            return;
+        used -= size;
+        std::map<size_t, size_t>::iterator next = freeBlocks.lower_bound(offset);
+        if (next != freeBlocks.begin()) {
+            std::map<size_t, size_t>::iterator previous = std::prev(next);
+            if (previous->first + previous->second == offset) {
+                offset = previous->first;
+                size += previous->second;
+                freeBlocks.erase(previous);
+            }
+        }
+        if (next != freeBlocks.end() && offset + size == next->first) {
+            size += next->second;
+            freeBlocks.erase(next);
+        }
+        freeBlocks[offset] = size;
+    }
+
+    // Extend the range, the new space is merged with a free block at the end
+    void grow(size_t capacity) {
+        if (capacity <= total)
+            return;
+        size_t added = capacity - total;
+        size_t start = total;
+        total = capacity;
+        used += added;
+        free(start, added);
+    }
+
+    size_t capacity() const {
+        return total;
+    }
+
+    size_t usedSize() const {
+        return used;
+    }
+
+private:
+    std::map<size_t, size_t> freeBlocks; // offset -> size
+    size_t total;
+    size_t used;
+};
+
+// One large VBO + IBO shared by every mesh, drawn from a single VAO with
+// glDrawElementsBaseVertex. Meshes can be added and released at any time;
+// the buffers are only reallocated when they run out of space.
+class MeshArena {
+public:
+    // Vertex layout matching Object: position, normal, uv
+    static const unsigned int FLOATS_PER_VERTEX = 8;
+
+    MeshArena(size_t vertexCapacity = 1 << 18, size_t indexCapacity = 1 << 20)
+        : vertexRanges(vertexCapacity), indexRanges(indexCapacity), staging(nullptr) {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * FLOATS_PER_VERTEX * sizeof(float), NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+        setupVertexArray();
+    }
+
+    // Delete the GL objects, must run while the context is still alive
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+
+    // Send later uploads through a stream buffer instead of glBufferSubData,
+    // so meshes added while drawing do not stall on buffers in use
+    void setStaging(StreamBuffer* stream) {
+        staging = stream;
+    }
+
+    // Take another reference to a mesh uploaded earlier under key
+    bool acquire(const std::string& key, MeshHandle& handle) {
+        std::map<std::string, int>::iterator it = byKey.find(key);
+        if (key.empty() || it == byKey.end())
+            return false;
+        ++entries[it->second].references;
+        handle = entries[it->second].handle;
+        return true;
+    }
+
+    // Copy a mesh into the arena, an empty key means the mesh is never shared
+    MeshHandle upload(const std::string& key, const float* vertices, size_t vertexFloatCount, const unsigned int* indices, size_t indexCount) {
+        MeshHandle handle;
+        size_t vertexCount = vertexFloatCount / FLOATS_PER_VERTEX;
+        size_t vertexOffset = allocate(vertexRanges, vertexCount, VBO, FLOATS_PER_VERTEX * sizeof(float));
+        size_t indexOffset = allocate(indexRanges, indexCount, EBO, sizeof(unsigned int));
+        if (vertexOffset == RangeAllocator::INVALID || indexOffset == RangeAllocator::INVALID) {
+            std::cerr << "ERROR::MESHARENA::OUT_OF_MEMORY" << std::endl;
+            if (vertexOffset != RangeAllocator::INVALID)
+                vertexRanges.free(vertexOffset, vertexCount);
+            if (indexOffset != RangeAllocator::INVALID)
+                indexRanges.free(indexOffset, indexCount);
+            return handle;
+        }
+
+        write(VBO, vertexOffset * FLOATS_PER_VERTEX * sizeof(float), vertices, vertexCount * FLOATS_PER_VERTEX * sizeof(float));
+        write(EBO, indexOffset * sizeof(unsigned int), indices, indexCount * sizeof(unsigned int));
+
+        handle.baseVertex = (GLint)vertexOffset;
+        handle.vertexCount = (unsigned int)vertexCount;
+        handle.firstIndex = (unsigned int)indexOffset;
+        handle.indexCount = (unsigned int)indexCount;
+        handle.id = newEntry(key, handle);
+        return handle;
+    }
+
+    // Drop a reference, the space is reused once the last one is gone
+    void release(MeshHandle& handle) {
+        if (!handle.valid())
+            return;
+        Entry& entry = entries[handle.id];
+        if (--entry.references == 0) {
+            vertexRanges.free(entry.handle.baseVertex, entry.handle.vertexCount);
+            indexRanges.free(entry.handle.firstIndex, entry.handle.indexCount);
+            if (!entry.key.empty())
+                byKey.erase(entry.key);
+            entry.key.clear();
+            freeIds.push_back(handle.id);
+        }
+        handle = MeshHandle();
+    }
+
+    // Bind the shared VAO, once per frame for all arena draws
+    void bind() const {
+        glBindVertexArray(VAO);
+    }
+
+    unsigned int vertexArray() const {
+        return VAO;
+    }
+
+    // Current buffer names, they change when the arena grows
+    unsigned int vertexBuffer() const {
+        return VBO;
+    }
+
+    unsigned int indexBuffer() const {
+        return EBO;
+    }
+
+    void draw(const MeshHandle& handle) const {
+        if (!handle.valid())
+            return;
+        glDrawElementsBaseVertex(GL_TRIANGLES, handle.indexCount, GL_UNSIGNED_INT,
+            (void*)(handle.firstIndex * sizeof(unsigned int)), handle.baseVertex);
+    }
+
+    size_t vertexCapacity() const { return vertexRanges.capacity(); }
+    size_t vertexUsage() const { return vertexRanges.usedSize(); }
+    size_t indexCapacity() const { return indexRanges.capacity(); }
+    size_t indexUsage() const { return indexRanges.usedSize(); }
+    size_t meshCount() const { return entries.size() - freeIds.size(); }
+
+private:
+    struct Entry {
+        std::string key;
+        MeshHandle handle;
+        int references;
+    };
+
+    unsigned int VAO, VBO, EBO;
+    RangeAllocator vertexRanges;
+    RangeAllocator indexRanges;
+    std::vector<Entry> entries;
+    std::vector<int> freeIds;
+    std::map<std::string, int> byKey;
+    StreamBuffer* staging;
+
+    void write(unsigned int buffer, size_t offset, const void* data, size_t size) {
+        if (staging) {
+            staging->upload(buffer, offset, data, size);
+            return;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+    }
+
+    void setupVertexArray() {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+    }
+
+    int newEntry(const std::string& key, const MeshHandle& handle) {
+        int id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else {
+            id = (int)entries.size();
+            entries.push_back(Entry());
+        }
+        entries[id].key = key;
+        entries[id].handle = handle;
+        entries[id].handle.id = id;
+        entries[id].references = 1;
+        if (!key.empty())
+            byKey[key] = id;
+        return id;
+    }
+
+    // Allocate count elements, doubling the GL buffer (and copying its contents) when full
+    size_t allocate(RangeAllocator& ranges, size_t count, unsigned int& buffer, size_t elementSize) {
+        size_t offset = ranges.allocate(count);
+        if (offset != RangeAllocator::INVALID || count == 0)
+            return offset;
+
+        size_t oldCapacity = ranges.capacity();
+        size_t newCapacity = std::max(oldCapacity * 2, oldCapacity + count);
+        unsigned int grown;
+        glGenBuffers(1, &grown);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+        glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * elementSize, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldCapacity * elementSize);
+        glDeleteBuffers(1, &buffer);
+        buffer = grown;
+        ranges.grow(newCapacity);
+        setupVertexArray();
+        return ranges.allocate(count);
+    }
+};
+
+#endif
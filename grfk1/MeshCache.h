@@ -0,0 +1,232 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <sys/stat.h>
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+// Mesh that lives in a mapped cache file. Pointers stay valid while the view is alive.
+struct MeshView {
+    MappedFile file;
+    const float* vertices = nullptr;
+    size_t vertexFloatCount = 0;
+    const unsigned int* indices = nullptr;
+    size_t indexCount = 0;
+};
+
+// Versioned binary cache of final vertex/index buffers, one file per key:
+//
+//   Header | Section[sectionCount] | payloads (each aligned to PAYLOAD_ALIGNMENT)
+//
+// Every payload and the section table carry a checksum; files with a different
+// version, vertex layout or key are ignored and rebuilt.
+class MeshCache {
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t VERTEX_STRIDE = 8 * sizeof(float);
+
+    explicit MeshCache(const std::string& directory = "cache") : directory(directory), hits(0), misses(0) {
+    }
+
+    // Map a cached mesh, false when missing, stale or corrupt
+    bool load(const std::string& key, MeshView& view) {
+        MappedFile file;
+        if (!file.open(pathFor(key)) || !validate(file, key, view)) {
+            ++misses;
+            return false;
+        }
+        view.file = std::move(file);
+        ++hits;
+        return true;
+    }
+
+    // Write a mesh for key, replacing any older file atomically
+    bool store(const std::string& key, const float* vertices, size_t vertexFloatCount, const unsigned int* indices, size_t indexCount) {
+        makeDirectory();
+        Section sections[SECTION_COUNT] = {};
+        const void* payloads[SECTION_COUNT] = { key.data(), vertices, indices };
+        sections[0].type = SECTION_KEY;
+        sections[0].size = key.size();
+        sections[1].type = SECTION_VERTICES;
+        sections[1].size = vertexFloatCount * sizeof(float);
+        sections[2].type = SECTION_INDICES;
+        sections[2].size = indexCount * sizeof(unsigned int);
+
+        uint64_t offset = align(sizeof(Header) + sizeof(sections));
+        for (Section& section : sections) {
+            section.offset = offset;
+            offset = align(offset + section.size);
+        }
+        for (uint32_t s = 0; s < SECTION_COUNT; ++s)
+            sections[s].checksum = checksum(payloads[s], (size_t)sections[s].size);
+
+        Header header = {};
+        memcpy(header.magic, magic(), 4);
+        header.version = VERSION;
+        header.vertexStride = VERTEX_STRIDE;
+        header.sectionCount = SECTION_COUNT;
+        header.fileSize = offset;
+        header.tableChecksum = checksum(sections, sizeof(sections));
+
+        std::string path = pathFor(key);
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            out.write((const char*)&header, sizeof(header));
+            out.write((const char*)sections, sizeof(sections));
+            static const char padding[PAYLOAD_ALIGNMENT] = {};
+            uint64_t written = sizeof(header) + sizeof(sections);
+            for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+                out.write(padding, (std::streamsize)(sections[s].offset - written));
+                out.write((const char*)payloads[s], (std::streamsize)sections[s].size);
+                written = sections[s].offset + sections[s].size;
+            }
+            out.write(padding, (std::streamsize)(offset - written));
+            if (!out)
+                return false;
+        }
+        std::remove(path.c_str());
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+
+    bool store(const std::string& key, const std::vector<float>& vertices, const std::vector<unsigned int>& indices) {
+        return store(key, vertices.data(), vertices.size(), indices.data(), indices.size());
+    }
+
+    // Keys describing how a mesh was produced
+    static std::string sphereKey(float radius, unsigned int longitudeSegments, unsigned int latitudeSegments) {
+        std::ostringstream key;
+        key << "sphere r=" << std::setprecision(9) << radius << " lon=" << longitudeSegments << " lat=" << latitudeSegments;
+        return key.str();
+    }
+
+    // Source files are keyed by path, size and modification time so edits invalidate the entry
+    static std::string fileKey(const std::string& kind, const std::string& path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            return std::string();
+        std::ostringstream key;
+        key << kind << " " << path << " size=" << (long long)info.st_size << " mtime=" << (long long)info.st_mtime;
+        return key.str();
+    }
+
+    unsigned int hitCount() const {
+        return hits;
+    }
+
+    unsigned int missCount() const {
+        return misses;
+    }
+
+private:
+    static const uint32_t SECTION_KEY = 1;
+    static const uint32_t SECTION_VERTICES = 2;
+    static const uint32_t SECTION_INDICES = 3;
+    static const uint32_t SECTION_COUNT = 3;
+    static const size_t PAYLOAD_ALIGNMENT = 64;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertexStride;
+        uint32_t sectionCount;
+        uint64_t fileSize;
+        uint64_t tableChecksum;
+    };
+
+    struct Section {
+        uint32_t type;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t size;
+        uint64_t checksum;
+    };
+
+    std::string directory;
+    unsigned int hits;
+    unsigned int misses;
+
+    static const char* magic() {
+        return "GKMC";
+    }
+
+    static uint64_t align(uint64_t value) {
+        return (value + PAYLOAD_ALIGNMENT - 1) & ~(uint64_t)(PAYLOAD_ALIGNMENT - 1);
+    }
+
+    // FNV-1a over 64-bit words, bytewise for the tail
+    static uint64_t checksum(const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        uint64_t hash = 0xCBF29CE484222325ull;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            hash = (hash ^ word) * 0x100000001B3ull;
+        }
+        for (; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        return hash ^ size;
+    }
+
+    static uint64_t hashKey(const std::string& key) {
+        return checksum(key.data(), key.size());
+    }
+
+    std::string pathFor(const std::string& key) const {
+        std::ostringstream path;
+        path << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << hashKey(key) << ".mesh";
+        return path.str();
+    }
+
+    void makeDirectory() const {
+#ifdef _WIN32
+        _mkdir(directory.c_str());
+#else
+        mkdir(directory.c_str(), 0755);
+#endif
+    }
+
+    static bool validate(const MappedFile& file, const std::string& key, MeshView& view) {
+        if (file.size() < sizeof(Header) + SECTION_COUNT * sizeof(Section))
+            return false;
+        Header header;
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, magic(), 4) != 0 || header.version != VERSION || header.vertexStride != VERTEX_STRIDE
+            || header.sectionCount != SECTION_COUNT || header.fileSize != file.size())
+            return false;
+        const Section* sections = (const Section*)(file.data() + sizeof(Header));
+        if (checksum(sections, SECTION_COUNT * sizeof(Section)) != header.tableChecksum)
+            return false;
+        for (uint32_t s = 0; s < SECTION_COUNT; ++s) {
+            const Section& section = sections[s];
+            if (section.type != s + 1 || section.offset % PAYLOAD_ALIGNMENT != 0
+                || section.offset > file.size() || section.size > file.size() - section.offset) // offset + size could wrap
+                return false;
+            if (checksum(file.data() + section.offset, (size_t)section.size) != section.checksum)
+                return false;
+        }
+        if (sections[0].size != key.size() || memcmp(file.data() + sections[0].offset, key.data(), key.size()) != 0)
+            return false;
+        view.vertices = (const float*)(file.data() + sections[1].offset);
+        view.vertexFloatCount = (size_t)(sections[1].size / sizeof(float));
+        view.indices = (const unsigned int*)(file.data() + sections[2].offset);
+        view.indexCount = (size_t)(sections[2].size / sizeof(unsigned int));
+        return view.vertexFloatCount > 0 && view.indexCount > 0;
+    }
+};
+
+#endif
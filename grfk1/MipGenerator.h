@@ -0,0 +1,261 @@
+#ifndef MIPGENERATOR_H
+#define MIPGENERATOR_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "ThreadPool.h"
+
+// Widest instruction set the compiler targets; /arch:AVX (or -mavx) widens the vertical
+// pass to 8 floats, x64 always has SSE2. Define MIP_NO_SIMD for the scalar path.
+#if !defined(MIP_NO_SIMD) && defined(__AVX__)
+#include <immintrin.h>
+#define MIP_AVX
+#define MIP_SSE
+#elif !defined(MIP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define MIP_SSE
+#endif
+
+// Mip chains built on the CPU instead of glGenerateMipmap. Colour channels are decoded
+// from sRGB to linear floats, every level is filtered from the previous float level
+// (separable, horizontal then vertical, edges clamped) and encoded back to sRGB bytes;
+// alpha is filtered as is. Sizes halve rounding down, as GL expects. With a pool large
+// levels are split by rows across the workers, the call may come from a worker itself.
+//
+// One channel at a time, and level 0 is read from the bytes row by row: besides the
+// output only the previous level of one channel is kept as floats, and the horizontal
+// pass runs in bands of BAND_ROWS output rows that feed the vertical pass directly.
+// Besides the chain itself that is about one byte per level 0 texel, a third of an RGB image.
+class MipGenerator {
+public:
+    enum Filter {
+        BOX,    // 2x2 average
+        KAISER  // 8-tap Kaiser-windowed sinc, sharper with little ringing
+    };
+
+    // Below this many texels per level threads cost more than they save
+    static const size_t PARALLEL_MIN = 64 * 1024;
+
+    // Output rows per band of the horizontal pass
+    static const int BAND_ROWS = 32;
+
+    // Level 0 (moved in) followed by every smaller level down to 1x1, tightly packed bytes
+    static std::vector<std::vector<unsigned char>> build(std::vector<unsigned char> pixels, int width, int height, int channels,
+                                                         Filter filter = KAISER, ThreadPool* pool = nullptr) {
+        std::vector<std::vector<unsigned char>> levels;
+        levels.push_back(std::move(pixels));
+        if (width <= 1 && height <= 1)
+            return levels;
+
+        const Kernel& kernel = filter == KAISER ? kaiserKernel() : boxKernel();
+        std::vector<int> widths(1, width), heights(1, height);
+        while (widths.back() > 1 || heights.back() > 1) {
+            widths.push_back(std::max(1, widths.back() / 2));
+            heights.push_back(std::max(1, heights.back() / 2));
+            levels.push_back(std::vector<unsigned char>((size_t)widths.back() * heights.back() * channels));
+        }
+
+        const float* linear = srgbToLinear();
+        std::vector<float> plane, halved;
+        for (int c = 0; c < channels; ++c) {
+            bool alpha = isAlpha(c, channels);
+            for (size_t level = 1; level < levels.size(); ++level) {
+                int sourceWidth = widths[level - 1], sourceHeight = heights[level - 1];
+                int nextWidth = widths[level], nextHeight = heights[level];
+                const unsigned char* bytes = levels[0].data();
+                const float* source = plane.data();
+                halved.resize((size_t)nextWidth * nextHeight);
+                forRows(pool, nextHeight, (size_t)nextWidth * nextHeight, [&](size_t begin, size_t end) {
+                    std::vector<float> padded, line(level == 1 ? sourceWidth : 0), band;
+                    std::vector<const float*> sources(kernel.weights.size());
+                    for (int bandBegin = (int)begin; bandBegin < (int)end; bandBegin += BAND_ROWS) {
+                        int bandEnd = std::min((int)end, bandBegin + BAND_ROWS);
+                        // Source rows the band's vertical taps reach, clamped to the image
+                        int first = std::max(2 * bandBegin + kernel.first, 0);
+                        int last = std::min(2 * (bandEnd - 1) + kernel.first + (int)kernel.weights.size() - 1, sourceHeight - 1);
+                        band.resize((size_t)(last - first + 1) * nextWidth);
+                        for (int y = first; y <= last; ++y) {
+                            const float* row;
+                            if (level == 1) {
+                                // Level 0 straight from the bytes
+                                const unsigned char* pixels = bytes + (size_t)y * sourceWidth * channels + c;
+                                for (int x = 0; x < sourceWidth; ++x)
+                                    line[x] = alpha ? pixels[(size_t)x * channels] / 255.0f : linear[pixels[(size_t)x * channels]];
+                                row = line.data();
+                            }
+                            else
+                                row = source + (size_t)y * sourceWidth;
+                            filterRow(row, sourceWidth, &band[(size_t)(y - first) * nextWidth], nextWidth, kernel, padded);
+                        }
+                        for (int y = bandBegin; y < bandEnd; ++y) {
+                            for (size_t k = 0; k < sources.size(); ++k) {
+                                int sourceRow = std::min(std::max(2 * y + kernel.first + (int)k, 0), sourceHeight - 1);
+                                sources[k] = &band[(size_t)(sourceRow - first) * nextWidth];
+                            }
+                            filterColumns(sources, nextWidth, &halved[(size_t)y * nextWidth], kernel);
+                        }
+                    }
+                });
+                plane.swap(halved);
+                encode(plane, nextWidth, nextHeight, c, channels, levels[level], pool);
+            }
+        }
+        return levels;
+    }
+
+private:
+    // Weights of source texels first .. first + weights.size() - 1 around 2x (+ 0.5 is the centre)
+    struct Kernel {
+        int first;
+        std::vector<float> weights;
+    };
+
+    static const Kernel& boxKernel() {
+        static const Kernel kernel = { 0, { 0.5f, 0.5f } };
+        return kernel;
+    }
+
+    static const Kernel& kaiserKernel() {
+        static const Kernel kernel = makeKaiser(4, 4.0f);
+        return kernel;
+    }
+
+    // Sinc windowed over radius source texels each side (radius / 2 destination texels)
+    static Kernel makeKaiser(int radius, float alpha) {
+        Kernel kernel;
+        kernel.first = 1 - radius;
+        float sum = 0.0f;
+        for (int k = 0; k < 2 * radius; ++k) {
+            double t = (kernel.first + k - 0.5) / 2.0; // distance from the centre in destination texels
+            double x = t / (radius / 2.0);
+            double sinc = t == 0.0 ? 1.0 : std::sin(3.14159265358979 * t) / (3.14159265358979 * t);
+            double window = x * x < 1.0 ? besselI0(alpha * std::sqrt(1.0 - x * x)) / besselI0(alpha) : 0.0;
+            kernel.weights.push_back((float)(sinc * window));
+            sum += kernel.weights.back();
+        }
+        for (float& weight : kernel.weights)
+            weight /= sum;
+        return kernel;
+    }
+
+    static double besselI0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    static bool isAlpha(int channel, int channels) {
+        return (channels == 4 && channel == 3) || (channels == 2 && channel == 1);
+    }
+
+    static const float* srgbToLinear() {
+        static const std::vector<float> table = [] {
+            std::vector<float> result(256);
+            for (int i = 0; i < 256; ++i) {
+                float s = i / 255.0f;
+                result[i] = s <= 0.04045f ? s / 12.92f : std::pow((s + 0.055f) / 1.055f, 2.4f);
+            }
+            return result;
+        }();
+        return table.data();
+    }
+
+    // Indexed by linear * LINEAR_STEPS, fine enough to round-trip every byte
+    static const int LINEAR_STEPS = 16383;
+
+    static const unsigned char* linearToSrgb() {
+        static const std::vector<unsigned char> table = [] {
+            std::vector<unsigned char> result(LINEAR_STEPS + 1);
+            for (int i = 0; i <= LINEAR_STEPS; ++i) {
+                float l = (float)i / LINEAR_STEPS;
+                float s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                result[i] = (unsigned char)(s * 255.0f + 0.5f);
+            }
+            return result;
+        }();
+        return table.data();
+    }
+
+    template <class F>
+    static void forRows(ThreadPool* pool, int rows, size_t texels, const F& body) {
+        if (pool && texels >= PARALLEL_MIN)
+            pool->parallelFor((size_t)rows, [&body](size_t begin, size_t end, unsigned int) { body(begin, end); });
+        else
+            body(0, (size_t)rows);
+    }
+
+    // One channel's float plane into its bytes of the interleaved level
+    static void encode(const std::vector<float>& plane, int width, int height, int channel, int channels, std::vector<unsigned char>& pixels, ThreadPool* pool) {
+        const unsigned char* srgb = linearToSrgb();
+        bool alpha = isAlpha(channel, channels);
+        forRows(pool, height, (size_t)width * height, [&](size_t begin, size_t end) {
+            for (size_t i = begin * width; i < end * width; ++i) {
+                float value = std::min(1.0f, std::max(0.0f, plane[i])); // the Kaiser lobes may overshoot
+                pixels[i * channels + channel] = alpha ? (unsigned char)(value * 255.0f + 0.5f) : srgb[(int)(value * LINEAR_STEPS + 0.5f)];
+            }
+        });
+    }
+
+    // Halve one row: out[x] = sum of weights[k] * row[2x + first + k], indices clamped
+    static void filterRow(const float* row, int width, float* out, int outWidth, const Kernel& kernel, std::vector<float>& padded) {
+        int taps = (int)kernel.weights.size(), left = -kernel.first;
+        // Clamped copy with room for the last 4-wide group to read 8 texels past each tap
+        padded.resize((size_t)2 * outWidth + left + taps + 8);
+        for (int i = 0; i < (int)padded.size(); ++i)
+            padded[i] = row[std::min(std::max(i - left, 0), width - 1)];
+        const float* source = padded.data(); // source[2x + k] is row[2x + first + k]
+        int x = 0;
+#if defined(MIP_SSE)
+        for (; x + 4 <= outWidth; x += 4) {
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < taps; ++k) {
+                // Every second texel from 2x + k on
+                __m128 a = _mm_loadu_ps(source + 2 * x + k), b = _mm_loadu_ps(source + 2 * x + k + 4);
+                __m128 even = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.weights[k]), even));
+            }
+            _mm_storeu_ps(out + x, sum);
+        }
+#endif
+        for (; x < outWidth; ++x) {
+            float sum = 0.0f;
+            for (int k = 0; k < taps; ++k)
+                sum += kernel.weights[k] * source[2 * x + k];
+            out[x] = sum;
+        }
+    }
+
+    // One output row of the vertical pass, sources[k] is the horizontally filtered row under tap k
+    static void filterColumns(const std::vector<const float*>& sources, int width, float* out, const Kernel& kernel) {
+        int taps = (int)kernel.weights.size();
+        int x = 0;
+#if defined(MIP_AVX)
+        for (; x + 8 <= width; x += 8) {
+            __m256 sum = _mm256_setzero_ps();
+            for (int k = 0; k < taps; ++k)
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(kernel.weights[k]), _mm256_loadu_ps(sources[k] + x)));
+            _mm256_storeu_ps(out + x, sum);
+        }
+#endif
+#if defined(MIP_SSE)
+        for (; x + 4 <= width; x += 4) {
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < taps; ++k)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.weights[k]), _mm_loadu_ps(sources[k] + x)));
+            _mm_storeu_ps(out + x, sum);
+        }
+#endif
+        for (; x < width; ++x) {
+            float sum = 0.0f;
+            for (int k = 0; k < taps; ++k)
+                sum += kernel.weights[k] * sources[k][x];
+            out[x] = sum;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,452 @@
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include "ThreadPool.h"
+
+// Mesh in the layout Object uploads: 8 floats per vertex (position, normal, uv)
+struct MeshData {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+// Timings and sizes of the last load, in milliseconds and counts
+struct ObjLoadStats {
+    double readMs = 0.0;
+    double parseMs = 0.0;
+    double dedupMs = 0.0;
+    double totalMs = 0.0;
+    size_t fileBytes = 0;
+    size_t triangles = 0;
+    size_t corners = 0;
+    size_t uniqueVertices = 0;
+    unsigned int threads = 0;
+};
+
+// Wavefront OBJ parser. The file is read in one block, split into line ranges
+// that are parsed in parallel, and face corners are merged through a hash table.
+class ObjLoader {
+public:
+    // Load an OBJ file into mesh, returns false (and leaves mesh untouched) on failure.
+    // Without a pool the file is parsed on the calling thread.
+    static bool load(const std::string& path, MeshData& mesh, ObjLoadStats* stats = nullptr, ThreadPool* pool = nullptr) {
+        Clock::time_point start = Clock::now();
+
+        std::vector<char> text;
+        if (!readFile(path, text))
+            return false;
+        Clock::time_point read = Clock::now();
+
+        ObjLoadStats local;
+        local.fileBytes = text.size();
+        if (!parse(text.data(), text.size(), mesh, local, pool)) {
+            std::cerr << "ERROR::OBJLOADER::INVALID_FILE " << path << std::endl;
+            return false;
+        }
+        local.readMs = msBetween(start, read);
+        local.totalMs = msBetween(start, Clock::now());
+        if (stats)
+            *stats = local;
+        return true;
+    }
+
+    // Parse OBJ text that is already in memory
+    static bool parse(const char* text, size_t size, MeshData& mesh, ObjLoadStats& stats, ThreadPool* pool = nullptr) {
+        Clock::time_point start = Clock::now();
+
+        ThreadPool* workers = size >= MIN_BYTES_PER_THREAD * 2 ? pool : nullptr;
+
+        // Split into line ranges of at least MIN_BYTES_PER_THREAD each
+        size_t chunkCount = workers ? std::min<size_t>(workers->size() + 1, std::max<size_t>(1, size / MIN_BYTES_PER_THREAD)) : 1;
+        std::vector<Chunk> chunks(chunkCount);
+        size_t begin = 0;
+        for (size_t c = 0; c < chunkCount; ++c) {
+            size_t end = (c + 1 == chunkCount) ? size : std::max(begin, size * (c + 1) / chunkCount);
+            while (end > 0 && end < size && text[end - 1] != '\n')
+                ++end;
+            chunks[c].begin = text + begin;
+            chunks[c].end = text + end;
+            begin = end;
+        }
+        stats.threads = (unsigned int)chunkCount;
+
+        // First pass counts elements so every chunk knows its global index offsets
+        forEachChunk(workers, chunks, [](Chunk& chunk) { countChunk(chunk); });
+        size_t positionCount = 0, uvCount = 0, normalCount = 0;
+        for (Chunk& chunk : chunks) {
+            chunk.positionBase = positionCount;
+            chunk.uvBase = uvCount;
+            chunk.normalBase = normalCount;
+            positionCount += chunk.positionCount;
+            uvCount += chunk.uvCount;
+            normalCount += chunk.normalCount;
+        }
+
+        // Second pass writes attributes in place and resolves face indices
+        std::vector<float> positions(positionCount * 3);
+        std::vector<float> uvs(uvCount * 2);
+        std::vector<float> normals(normalCount * 3);
+        forEachChunk(workers, chunks, [&](Chunk& chunk) {
+            parseChunk(chunk, positions.data(), uvs.data(), normals.data());
+        });
+        size_t cornerCount = 0;
+        for (Chunk& chunk : chunks) {
+            if (!chunk.valid)
+                return false;
+            cornerCount += chunk.corners.size();
+        }
+        if (cornerCount == 0)
+            return false;
+        Clock::time_point parsed = Clock::now();
+
+        // Merge identical (position, uv, normal) corners into shared vertices
+        std::vector<Corner> unique;
+        std::vector<unsigned int> indices;
+        unique.reserve(cornerCount / 3 + 16);
+        indices.reserve(cornerCount);
+        CornerTable table(cornerCount / 4, positionCount);
+        bool needNormals = false;
+        for (const Chunk& chunk : chunks) {
+            for (const Corner& corner : chunk.corners) {
+                indices.push_back(table.insert(corner, unique));
+                needNormals |= corner.normal == NONE;
+            }
+        }
+        std::vector<float> smoothNormals;
+        if (needNormals)
+            computeNormals(positions, indices, unique, smoothNormals);
+
+        std::vector<float> vertices(unique.size() * 8);
+        const Corner* uniqueData = unique.data();
+        auto fill = [&](size_t first, size_t last, unsigned int) {
+            for (size_t i = first; i < last; ++i) {
+                const Corner& corner = uniqueData[i];
+                float* out = &vertices[i * 8];
+                const float* p = &positions[corner.position * 3];
+                const float* n = corner.normal != NONE ? &normals[corner.normal * 3] : &smoothNormals[corner.position * 3];
+                out[0] = p[0]; out[1] = p[1]; out[2] = p[2];
+                out[3] = n[0]; out[4] = n[1]; out[5] = n[2];
+                out[6] = corner.uv != NONE ? uvs[corner.uv * 2] : 0.0f;
+                out[7] = corner.uv != NONE ? uvs[corner.uv * 2 + 1] : 0.0f;
+            }
+        };
+        if (workers)
+            workers->parallelFor(unique.size(), fill);
+        else
+            fill(0, unique.size(), 0);
+
+        mesh.vertices.swap(vertices);
+        mesh.indices.swap(indices);
+
+        stats.parseMs = msBetween(start, parsed);
+        stats.dedupMs = msBetween(parsed, Clock::now());
+        stats.corners = cornerCount;
+        stats.triangles = cornerCount / 3;
+        stats.uniqueVertices = unique.size();
+        return true;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    static const uint32_t NONE = 0xFFFFFFFFu;
+    static const size_t MIN_BYTES_PER_THREAD = 1 << 20;
+
+    // Face corner as 0-based attribute indices, NONE when absent
+    struct Corner {
+        uint32_t position, uv, normal;
+    };
+
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        size_t positionCount = 0, uvCount = 0, normalCount = 0;
+        size_t positionBase = 0, uvBase = 0, normalBase = 0;
+        size_t cornerEstimate = 0;
+        std::vector<Corner> corners;
+        bool valid = true;
+    };
+
+    // Open addressing table from corner to output vertex index, kept at most half full.
+    // Keys are stored inline and slots are spread in position order, so faces that
+    // reference nearby vertices (the common case) probe nearby cache lines.
+    class CornerTable {
+    public:
+        CornerTable(size_t expected, size_t positionCount) : mask(0), count(0), positions(std::max<size_t>(1, positionCount)) {
+            resize(std::max(expected, positionCount));
+        }
+
+        unsigned int insert(const Corner& corner, std::vector<Corner>& unique) {
+            size_t slot = hash(corner) & mask;
+            for (;;) {
+                Entry& entry = slots[slot];
+                if (entry.index == 0)
+                    break;
+                if (entry.key.position == corner.position && entry.key.uv == corner.uv && entry.key.normal == corner.normal)
+                    return entry.index - 1;
+                slot = (slot + 1) & mask;
+            }
+            unique.push_back(corner);
+            slots[slot].key = corner;
+            slots[slot].index = (uint32_t)unique.size();
+            if (++count * 2 > slots.size())
+                rehash();
+            return (unsigned int)(unique.size() - 1);
+        }
+
+    private:
+        struct Entry {
+            Corner key;
+            uint32_t index; // output index + 1, 0 = empty
+        };
+        std::vector<Entry> slots;
+        size_t mask;
+        size_t count;
+        size_t positions;
+
+        void resize(size_t expected) {
+            size_t capacity = 64;
+            while (capacity < expected * 2)
+                capacity <<= 1;
+            Entry empty = { { 0, 0, 0 }, 0 };
+            slots.assign(capacity, empty);
+            mask = capacity - 1;
+        }
+
+        void rehash() {
+            std::vector<Entry> old;
+            old.swap(slots);
+            resize(old.size());
+            for (const Entry& entry : old) {
+                if (entry.index == 0)
+                    continue;
+                size_t slot = hash(entry.key) & mask;
+                while (slots[slot].index != 0)
+                    slot = (slot + 1) & mask;
+                slots[slot] = entry;
+            }
+        }
+
+        size_t hash(const Corner& corner) const {
+            return (size_t)((uint64_t)corner.position * slots.size() / positions);
+        }
+    };
+
+    static double msBetween(Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    }
+
+    static bool readFile(const std::string& path, std::vector<char>& text) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        std::streamoff size = file.tellg();
+        if (size <= 0)
+            return false;
+        text.resize((size_t)size);
+        file.seekg(0);
+        return (bool)file.read(text.data(), size);
+    }
+
+    template <class F>
+    static void forEachChunk(ThreadPool* workers, std::vector<Chunk>& chunks, F body) {
+        if (!workers || chunks.size() == 1) {
+            for (Chunk& chunk : chunks)
+                body(chunk);
+            return;
+        }
+        workers->parallelFor(chunks.size(), [&](size_t first, size_t last, unsigned int) {
+            for (size_t c = first; c < last; ++c)
+                body(chunks[c]);
+        });
+    }
+
+    static const char* nextLine(const char* p, const char* end) {
+        const void* newline = memchr(p, '\n', end - p);
+        return newline ? (const char*)newline + 1 : end;
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t';
+    }
+
+    static void countChunk(Chunk& chunk) {
+        for (const char* p = chunk.begin; p < chunk.end; p = nextLine(p, chunk.end)) {
+            while (p < chunk.end && isSpace(*p))
+                ++p;
+            if (chunk.end - p < 2)
+                continue;
+            if (p[0] == 'v') {
+                if (isSpace(p[1]))
+                    ++chunk.positionCount;
+                else if (p[1] == 't')
+                    ++chunk.uvCount;
+                else if (p[1] == 'n')
+                    ++chunk.normalCount;
+            }
+            else if (p[0] == 'f' && isSpace(p[1])) {
+                chunk.cornerEstimate += 6;
+            }
+        }
+    }
+
+    static const char* parseFloat(const char* p, const char* end, float& out) {
+        static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16 };
+        while (p < end && isSpace(*p))
+            ++p;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        double value = 0.0;
+        while (p < end && *p >= '0' && *p <= '9')
+            value = value * 10.0 + (*p++ - '0');
+        if (p < end && *p == '.') {
+            ++p;
+            double fraction = 0.0;
+            int digits = 0;
+            while (p < end && *p >= '0' && *p <= '9') {
+                if (digits < 16) {
+                    fraction = fraction * 10.0 + (*p - '0');
+                    ++digits;
+                }
+                ++p;
+            }
+            value += fraction / powers[digits];
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool negativeExponent = false;
+            if (p < end && (*p == '-' || *p == '+'))
+                negativeExponent = *p++ == '-';
+            int exponent = 0;
+            while (p < end && *p >= '0' && *p <= '9')
+                exponent = std::min(exponent * 10 + (*p++ - '0'), 400);
+            value = negativeExponent ? value / std::pow(10.0, exponent) : value * std::pow(10.0, exponent);
+        }
+        out = (float)(negative ? -value : value);
+        return p;
+    }
+
+    // Parse one face index, resolving negative (relative) indices against count
+    static const char* parseIndex(const char* p, const char* end, size_t count, uint32_t& out, bool& valid) {
+        bool negative = false;
+        if (p < end && *p == '-') {
+            negative = true;
+            ++p;
+        }
+        if (p >= end || *p < '0' || *p > '9') {
+            out = NONE;
+            return p;
+        }
+        int64_t value = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+            value = value * 10 + (*p++ - '0');
+        int64_t resolved = negative ? (int64_t)count - value : value - 1;
+        if (resolved < 0 || resolved >= (int64_t)count) {
+            valid = false;
+            out = 0;
+        }
+        else {
+            out = (uint32_t)resolved;
+        }
+        return p;
+    }
+
+    static void parseChunk(Chunk& chunk, float* positions, float* uvs, float* normals) {
+        size_t position = chunk.positionBase, uv = chunk.uvBase, normal = chunk.normalBase;
+        chunk.corners.reserve(chunk.cornerEstimate);
+        std::vector<Corner> polygon; // corners of the current face, reused across lines
+
+        for (const char* p = chunk.begin; p < chunk.end;) {
+            const char* lineEnd = nextLine(p, chunk.end);
+            while (p < lineEnd && isSpace(*p))
+                ++p;
+            if (lineEnd - p >= 2 && p[0] == 'v') {
+                if (isSpace(p[1])) {
+                    float* out = positions + position++ * 3;
+                    p = parseFloat(p + 1, lineEnd, out[0]);
+                    p = parseFloat(p, lineEnd, out[1]);
+                    parseFloat(p, lineEnd, out[2]);
+                }
+                else if (p[1] == 't') {
+                    float* out = uvs + uv++ * 2;
+                    p = parseFloat(p + 2, lineEnd, out[0]);
+                    parseFloat(p, lineEnd, out[1]);
+                }
+                else if (p[1] == 'n') {
+                    float* out = normals + normal++ * 3;
+                    p = parseFloat(p + 2, lineEnd, out[0]);
+                    p = parseFloat(p, lineEnd, out[1]);
+                    parseFloat(p, lineEnd, out[2]);
+                }
+            }
+            else if (lineEnd - p >= 2 && p[0] == 'f' && isSpace(p[1])) {
+                // Indices may only reference attributes declared before this line
+                polygon.clear();
+                ++p;
+                for (;;) {
+                    while (p < lineEnd && (isSpace(*p) || *p == '\r' || *p == '\n'))
+                        ++p;
+                    if (p >= lineEnd || *p == '#')
+                        break;
+                    Corner corner = { NONE, NONE, NONE };
+                    p = parseIndex(p, lineEnd, position, corner.position, chunk.valid);
+                    if (p < lineEnd && *p == '/') {
+                        p = parseIndex(p + 1, lineEnd, uv, corner.uv, chunk.valid);
+                        if (p < lineEnd && *p == '/')
+                            p = parseIndex(p + 1, lineEnd, normal, corner.normal, chunk.valid);
+                    }
+                    if (corner.position == NONE)
+                        chunk.valid = false;
+                    while (p < lineEnd && !isSpace(*p) && *p != '\r' && *p != '\n')
+                        ++p;
+                    polygon.push_back(corner);
+                }
+                // Triangulate as a fan
+                for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+                    chunk.corners.push_back(polygon[0]);
+                    chunk.corners.push_back(polygon[i]);
+                    chunk.corners.push_back(polygon[i + 1]);
+                }
+            }
+            if (!chunk.valid)
+                return;
+            p = lineEnd;
+        }
+    }
+
+    // Area weighted smooth normals per position, for corners without "vn"
+    static void computeNormals(const std::vector<float>& positions, const std::vector<unsigned int>& indices, const std::vector<Corner>& unique, std::vector<float>& out) {
+        out.assign(positions.size(), 0.0f);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            uint32_t a = unique[indices[i]].position, b = unique[indices[i + 1]].position, c = unique[indices[i + 2]].position;
+            const float* pa = &positions[a * 3];
+            const float* pb = &positions[b * 3];
+            const float* pc = &positions[c * 3];
+            float e1[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+            float e2[3] = { pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2] };
+            float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            for (uint32_t v : { a, b, c }) {
+                out[v * 3] += n[0];
+                out[v * 3 + 1] += n[1];
+                out[v * 3 + 2] += n[2];
+            }
+        }
+        for (size_t v = 0; v < out.size(); v += 3) {
+            float length = std::sqrt(out[v] * out[v] + out[v + 1] * out[v + 1] + out[v + 2] * out[v + 2]);
+            if (length > 0.0f) {
+                out[v] /= length;
+                out[v + 1] /= length;
+                out[v + 2] /= length;
+            }
+        }
+    }
+};
+
+#endif
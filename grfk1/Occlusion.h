@@ -0,0 +1,180 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "Shader.h"
+
+// Few large spheres (sun, gas giants) tested on the CPU against the bounding spheres
+// of other bodies. A sphere is hidden when it lies inside an occluder's silhouette cone
+// and its nearest point is farther than the occluder's center, which is always behind
+// the occluder's front surface.
+class SphereOccluders {
+public:
+    void clear() {
+        occluders.clear();
+    }
+
+    // radius should not exceed the drawn silhouette (tessellated spheres lie inside their sphere)
+    void add(const glm::vec3& center, float radius) {
+        occluders.push_back(glm::vec4(center, radius));
+    }
+
+    bool occluded(const glm::vec3& eye, const glm::vec3& center, float radius) const {
+        glm::vec3 toCenter = center - eye;
+        float distance = glm::length(toCenter);
+        if (distance <= radius)
+            return false;
+        float angularRadius = std::asin(radius / distance);
+        for (const glm::vec4& occluder : occluders) {
+            glm::vec3 toOccluder = glm::vec3(occluder) - eye;
+            float occluderDistance = glm::length(toOccluder);
+            if (occluderDistance <= occluder.w || distance - radius < occluderDistance)
+                continue;
+            float occluderAngularRadius = std::asin(occluder.w / occluderDistance);
+            float cosine = glm::dot(toCenter, toOccluder) / (distance * occluderDistance);
+            float separation = std::acos(std::min(1.0f, std::max(-1.0f, cosine)));
+            if (separation + angularRadius <= occluderAngularRadius)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    std::vector<glm::vec4> occluders; // center, radius
+};
+
+// GPU occlusion queries for expensive draws, one slot per object. Each frame a cube
+// around the object's bounding sphere is drawn without color or depth writes inside a
+// GL_SAMPLES_PASSED query; the draw itself uses the query from the previous frame, either
+// through conditional rendering or by reading the result when it is already available.
+// Queries never stall: a missing or pending result counts as visible.
+class OcclusionQueries {
+public:
+    explicit OcclusionQueries(unsigned int slotCount) : slots(slotCount), current(0), proxyCount(0) {
+        queries.resize(slots * 2);
+        issued.assign(slots * 2, false);
+        glGenQueries((GLsizei)queries.size(), queries.data());
+        setupCube();
+    }
+
+    void destroy() {
+        glDeleteQueries((GLsizei)queries.size(), queries.data());
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+    }
+
+    OcclusionQueries(const OcclusionQueries&) = delete;
+    OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+
+    // Swap to this frame's queries, call once per frame before occluded() and issue()
+    void beginFrame() {
+        current ^= 1;
+        for (unsigned int slot = 0; slot < slots; ++slot)
+            issued[slot * 2 + current] = false;
+        proxyCount = 0;
+    }
+
+    // True only when last frame's query finished with no samples
+    bool occluded(unsigned int slot) const {
+        unsigned int index = slot * 2 + (current ^ 1);
+        if (!issued[index])
+            return false;
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+        GLuint samples = 0;
+        glGetQueryObjectuiv(queries[index], GL_QUERY_RESULT, &samples);
+        return samples == 0;
+    }
+
+    // Draw only if last frame's query passed; returns false (and draws normally) without one
+    bool beginConditional(unsigned int slot) const {
+        unsigned int index = slot * 2 + (current ^ 1);
+        if (!issued[index])
+            return false;
+        glBeginConditionalRender(queries[index], GL_QUERY_NO_WAIT);
+        return true;
+    }
+
+    void endConditional() const {
+        glEndConditionalRender();
+    }
+
+    // Proxy pass, after the opaque geometry of the frame is in the depth buffer
+    void beginProxies(Shader& shader, const glm::mat4& viewProjection) {
+        shader.use();
+        shader.setMat4("viewProjection", viewProjection);
+        proxyShader = &shader;
+        glBindVertexArray(VAO);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+    }
+
+    // Query the cube around a sphere. Skipped when the camera is inside or too close to
+    // the cube (its faces would be clipped), which leaves the object visible next frame.
+    void issue(unsigned int slot, const glm::vec3& eye, float nearPlane, const glm::vec3& center, float radius) {
+        if (glm::length(eye - center) <= radius * 1.7320508f + nearPlane)
+            return;
+        unsigned int index = slot * 2 + current;
+        proxyShader->setVec3("center", center);
+        proxyShader->setFloat("radius", radius);
+        glBeginQuery(GL_SAMPLES_PASSED, queries[index]);
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+        glEndQuery(GL_SAMPLES_PASSED);
+        issued[index] = true;
+        ++proxyCount;
+    }
+
+    void endProxies() {
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+        glBindVertexArray(0);
+    }
+
+    unsigned int issuedCount() const {
+        return proxyCount;
+    }
+
+private:
+    unsigned int slots;
+    unsigned int current;
+    unsigned int proxyCount;
+    std::vector<GLuint> queries; // two per slot, alternating frames
+    std::vector<bool> issued;
+    unsigned int VAO, VBO;
+    Shader* proxyShader = nullptr;
+
+    // Unit cube [-1, 1]^3, both windings since culling is off
+    void setupCube() {
+        static const float corners[8][3] = {
+            { -1, -1, -1 }, { 1, -1, -1 }, { 1, 1, -1 }, { -1, 1, -1 },
+            { -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 }
+        };
+        static const unsigned int faces[6][4] = {
+            { 0, 1, 2, 3 }, { 5, 4, 7, 6 }, { 4, 0, 3, 7 }, { 1, 5, 6, 2 }, { 3, 2, 6, 7 }, { 4, 5, 1, 0 }
+        };
+        float vertices[36 * 3];
+        float* out = vertices;
+        for (const unsigned int* face : faces) {
+            const unsigned int quad[6] = { face[0], face[1], face[2], face[0], face[2], face[3] };
+            for (unsigned int corner : quad)
+                for (int axis = 0; axis < 3; ++axis)
+                    *out++ = corners[corner][axis];
+        }
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+    }
+};
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef ORBITLINES_H
+#define ORBITLINES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Shader.h"
+#include "StreamBuffer.h"
+
+// Keplerian orbit around the origin (the sun sits in the focus), angles in radians
+struct Orbit {
+    float semiMajorAxis = 1.0f;
+    float eccentricity = 0.0f;
+    float inclination = 0.0f;
+    float ascendingNode = 0.0f;
+    float phase = 0.0f;         // eccentric anomaly of the body at time 0
+    float angularSpeed = 0.0f;  // radians per second
+    glm::vec4 color = glm::vec4(1.0f);
+
+    bool operator==(const Orbit& other) const {
+        return semiMajorAxis == other.semiMajorAxis && eccentricity == other.eccentricity && inclination == other.inclination
+            && ascendingNode == other.ascendingNode && phase == other.phase && angularSpeed == other.angularSpeed && color == other.color;
+    }
+};
+
+// Orbit paths generated in orbit_vertex_shader.glsl: one instance per orbit holding only
+// its parameters, the ellipse points come from gl_VertexID. The shader picks the segment
+// count from the orbit's size on screen (unused segments collapse outside the clip volume)
+// and fades the path behind the body and for orbits too small to see.
+class OrbitLines {
+public:
+    static const unsigned int MAX_SEGMENTS = 512;
+    static const unsigned int FLOATS_PER_ORBIT = 12;
+
+    OrbitLines() : capacity(0), dirty(false), staging(nullptr) {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        for (unsigned int attribute = 0; attribute < 3; ++attribute) {
+            glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, FLOATS_PER_ORBIT * sizeof(float), (void*)(attribute * 4 * sizeof(float)));
+            glEnableVertexAttribArray(attribute);
+            glVertexAttribDivisor(attribute, 1);
+        }
+        glBindVertexArray(0);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+    }
+
+    OrbitLines(const OrbitLines&) = delete;
+    OrbitLines& operator=(const OrbitLines&) = delete;
+
+    // Send changed orbits through a stream buffer instead of glBufferSubData
+    void setStaging(StreamBuffer* stream) {
+        staging = stream;
+    }
+
+    unsigned int add(const Orbit& orbit) {
+        orbits.push_back(orbit);
+        dirty = true;
+        return (unsigned int)orbits.size() - 1;
+    }
+
+    // Replace an orbit, nothing is uploaded when it did not change
+    void set(unsigned int index, const Orbit& orbit) {
+        if (index >= orbits.size())
+            orbits.resize(index + 1);
+        else if (orbits[index] == orbit)
+            return;
+        orbits[index] = orbit;
+        dirty = true;
+    }
+
+    size_t size() const {
+        return orbits.size();
+    }
+
+    void bind() const {
+        glBindVertexArray(VAO);
+    }
+
+    unsigned int vertexArray() const {
+        return VAO;
+    }
+
+    // Draw all orbits in one instanced call, the VAO must be bound.
+    // projectionScale = viewport height / (2 tan(fov / 2)).
+    void draw(Shader& shader, float time, float projectionScale) {
+        if (orbits.empty())
+            return;
+        upload();
+        shader.setFloat("time", time);
+        shader.setFloat("projectionScale", projectionScale);
+        shader.setInt("maxSegments", (int)MAX_SEGMENTS);
+        glDrawArraysInstanced(GL_LINES, 0, MAX_SEGMENTS * 2, (GLsizei)orbits.size());
+    }
+
+private:
+    unsigned int VAO, VBO;
+    std::vector<Orbit> orbits;
+    size_t capacity;
+    bool dirty;
+    StreamBuffer* staging;
+
+    void upload() {
+        if (!dirty)
+            return;
+        std::vector<float> data;
+        data.reserve(orbits.size() * FLOATS_PER_ORBIT);
+        for (const Orbit& orbit : orbits) {
+            float packed[FLOATS_PER_ORBIT] = {
+                orbit.semiMajorAxis, orbit.eccentricity, orbit.inclination, orbit.ascendingNode,
+                orbit.phase, orbit.angularSpeed, 0.0f, 0.0f,
+                orbit.color.r, orbit.color.g, orbit.color.b, orbit.color.a
+            };
+            data.insert(data.end(), packed, packed + FLOATS_PER_ORBIT);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        if (orbits.size() > capacity) {
+            capacity = orbits.size();
+            glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_DYNAMIC_DRAW);
+        }
+        else if (staging) {
+            staging->upload(VBO, 0, data.data(), data.size() * sizeof(float));
+        }
+        else {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, data.size() * sizeof(float), data.data());
+        }
+        dirty = false;
+    }
+};
+
+#endif
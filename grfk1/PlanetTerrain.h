@@ -0,0 +1,423 @@
+#ifndef PLANETTERRAIN_H
+#define PLANETTERRAIN_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <queue>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "MeshArena.h"
+#include "ThreadPool.h"
+#include "IndirectBatch.h"
+
+// Planets larger than this on screen (radius in pixels) are drawn as terrain
+const float TERRAIN_MIN_RADIUS = 300.0f;
+
+// Displacement of the unit sphere: fractal value noise, in planet radii
+struct TerrainHeight {
+    unsigned int seed;
+    float amplitude;
+    unsigned int octaves;
+
+    float operator()(const glm::vec3& direction) const {
+        float sum = 0.0f;
+        float weight = 0.5f;
+        float frequency = 2.0f;
+        for (unsigned int octave = 0; octave < octaves; ++octave) {
+            sum += weight * valueNoise(direction * frequency, seed + octave * 1013u);
+            weight *= 0.5f;
+            frequency *= 2.0f;
+        }
+        return sum * amplitude;
+    }
+
+private:
+    static float hash(int x, int y, int z, unsigned int seed) {
+        unsigned int h = seed ^ ((unsigned int)x * 73856093u) ^ ((unsigned int)y * 19349663u) ^ ((unsigned int)z * 83492791u);
+        h ^= h >> 13;
+        h *= 0x5bd1e995u;
+        h ^= h >> 15;
+        return (float)(h & 0xFFFFFF) / (float)0x7FFFFF - 1.0f;
+    }
+
+    // Trilinear interpolation of random lattice values, in [-1, 1]
+    static float valueNoise(const glm::vec3& p, unsigned int seed) {
+        glm::vec3 cell = glm::floor(p);
+        glm::vec3 f = p - cell;
+        glm::vec3 s = f * f * (3.0f - 2.0f * f);
+        int x = (int)cell.x, y = (int)cell.y, z = (int)cell.z;
+        float result = 0.0f;
+        for (int corner = 0; corner < 8; ++corner) {
+            int dx = corner & 1, dy = (corner >> 1) & 1, dz = corner >> 2;
+            float w = (dx ? s.x : 1.0f - s.x) * (dy ? s.y : 1.0f - s.y) * (dz ? s.z : 1.0f - s.z);
+            result += w * hash(x + dx, y + dy, z + dz, seed);
+        }
+        return result;
+    }
+};
+
+// Cube-sphere terrain for close-ups of a planet. Every cube face is a quadtree of
+// chunks with a fixed GRID x GRID quad grid; chunks split while their geometric
+// error projects to more than maxErrorPixels and the triangle budget allows it.
+// Chunk vertices are built on worker threads and uploaded to the MeshArena on the
+// render thread; skirts hide the cracks between neighbours of different levels.
+// Everything is in planet space, so the planet's model matrix is used for drawing.
+class PlanetTerrain {
+public:
+    static const int GRID = 32;
+    static const int MAX_LEVEL = 14;
+    static const unsigned int TRIANGLES_PER_CHUNK = GRID * GRID * 2 + GRID * 4 * 2;
+    static const unsigned int MAX_UPLOADS_PER_FRAME = 8;
+    static constexpr float TERRAIN_SLOPE = 0.1f;
+
+    PlanetTerrain(MeshArena& arena, ThreadPool* pool, const TerrainHeight& height, unsigned int triangleBudget = 250000)
+        : arena(&arena), pool(pool), height(height), triangleBudget(triangleBudget), maxErrorPixels(2.0f), complete(false) {
+        for (int face = 0; face < 6; ++face)
+            roots[face].reset(new Node(face, 0, 0, 0));
+    }
+
+    PlanetTerrain(const PlanetTerrain&) = delete;
+    PlanetTerrain& operator=(const PlanetTerrain&) = delete;
+
+    // Pick the chunks to draw. cameraPosition is in planet space (planet radius = 1),
+    // projectionScale = viewport height / (2 tan(fov / 2)).
+    void update(const glm::vec3& cameraPosition, float projectionScale) {
+        uploadFinished();
+        drawList.clear();
+        complete = true;
+
+        unsigned int chunkBudget = triangleBudget / TRIANGLES_PER_CHUNK;
+        unsigned int chunkCount = 0;
+        std::priority_queue<Candidate> candidates;
+        for (int face = 0; face < 6; ++face) {
+            Node* root = roots[face].get();
+            request(*root);
+            if (!visible(*root, cameraPosition))
+                collapse(*root);
+            else if (!root->mesh.valid())
+                complete = false; // still on a worker, the face would be a hole
+            else {
+                root->error = screenError(*root, cameraPosition, projectionScale);
+                candidates.push(Candidate(root));
+                ++chunkCount;
+            }
+        }
+
+        while (!candidates.empty()) {
+            Node* node = candidates.top().node;
+            candidates.pop();
+            bool wantsSplit = node->error > maxErrorPixels && node->level < MAX_LEVEL;
+            // Budget first, childrenReady(..., true) starts building the children
+            if (wantsSplit && chunkCount + 3 <= chunkBudget && childrenReady(*node, true)) {
+                for (std::unique_ptr<Node>& child : node->children) {
+                    if (!visible(*child, cameraPosition)) {
+                        collapse(*child);
+                        continue;
+                    }
+                    child->error = screenError(*child, cameraPosition, projectionScale);
+                    candidates.push(Candidate(child.get()));
+                    ++chunkCount;
+                }
+                --chunkCount;
+                continue;
+            }
+            // Children far below the threshold are dropped, otherwise one level is kept for later
+            if (node->error < maxErrorPixels * 0.5f)
+                collapse(*node);
+            else
+                for (std::unique_ptr<Node>& child : node->children)
+                    if (child)
+                        collapse(*child);
+            drawList.push_back(node);
+        }
+    }
+
+    // Draw the chunks chosen by update, the arena VAO must be bound
+    void draw() const {
+        for (const Node* node : drawList)
+            arena->draw(node->mesh);
+    }
+
+    // Add the chosen chunks to an indirect batch, all drawn with the planet's instance
+    void collect(IndirectBatch& batch, unsigned int instance) const {
+        for (const Node* node : drawList)
+            batch.addDraw(node->mesh, instance);
+    }
+
+    // Release everything below the six root chunks, e.g. when the planet is far away
+    void collapse() {
+        drawList.clear();
+        complete = false;
+        for (int face = 0; face < 6; ++face)
+            collapse(*roots[face]);
+    }
+
+    // Return all meshes to the arena
+    void destroy() {
+        drawList.clear();
+        complete = false;
+        for (int face = 0; face < 6; ++face) {
+            release(*roots[face]);
+            roots[face].reset();
+        }
+    }
+
+    // True when the last update had the mesh of every visible root, so the chunks cover the
+    // whole visible planet; until then the caller keeps drawing the sphere
+    bool ready() const {
+        return complete && !drawList.empty();
+    }
+
+    size_t chunkCount() const {
+        return drawList.size();
+    }
+
+    unsigned int triangleCount() const {
+        return (unsigned int)drawList.size() * TRIANGLES_PER_CHUNK;
+    }
+
+private:
+    struct ChunkMesh {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    struct Node {
+        int face, level, x, y;
+        glm::vec3 center;      // on the unit sphere
+        float boundingRadius;  // around center, without the displacement
+        float geometricError;  // in planet radii
+        float error;           // in pixels, from the last update
+        MeshHandle mesh;
+        bool requested;
+        std::future<ChunkMesh> pending;
+        std::unique_ptr<Node> children[4];
+
+        Node(int face, int level, int x, int y) : face(face), level(level), x(x), y(y), error(0.0f), requested(false) {
+            float size = 2.0f / (float)(1 << level);
+            float a = -1.0f + size * (x + 0.5f), b = -1.0f + size * (y + 0.5f);
+            center = cubeToSphere(face, a, b);
+            boundingRadius = 0.0f;
+            for (int corner = 0; corner < 4; ++corner) {
+                glm::vec3 p = cubeToSphere(face, a + size * ((corner & 1) - 0.5f), b + size * ((corner >> 1) - 0.5f));
+                boundingRadius = std::max(boundingRadius, glm::length(p - center));
+            }
+            // Quad spacing (a quarter turn over GRID quads at level 0) times the typical terrain slope
+            geometricError = 1.5707963f / (float)(GRID << level) * TERRAIN_SLOPE;
+        }
+    };
+
+    struct Candidate {
+        Node* node;
+        explicit Candidate(Node* node) : node(node) {
+        }
+        bool operator<(const Candidate& other) const {
+            return node->error < other.node->error;
+        }
+    };
+
+    MeshArena* arena;
+    ThreadPool* pool;
+    TerrainHeight height;
+    unsigned int triangleBudget;
+    float maxErrorPixels;
+    std::unique_ptr<Node> roots[6];
+    std::vector<Node*> drawList;
+    bool complete; // no visible root was skipped in the last update
+    std::vector<Node*> inFlight;
+
+    // Point on the spherified cube, (a, b) in [-1, 1] on the given face
+    static glm::vec3 cubeToSphere(int face, float a, float b) {
+        static const glm::vec3 normals[6] = { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) };
+        static const glm::vec3 rights[6] = { glm::vec3(0, 0, -1), glm::vec3(0, 0, 1), glm::vec3(1, 0, 0), glm::vec3(1, 0, 0), glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0) };
+        static const glm::vec3 ups[6] = { glm::vec3(0, 1, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, -1), glm::vec3(0, 0, 1), glm::vec3(0, 1, 0), glm::vec3(0, 1, 0) };
+        glm::vec3 p = normals[face] + rights[face] * a + ups[face] * b;
+        glm::vec3 p2 = p * p;
+        // Even spacing mapping instead of normalize, keeps chunk sizes similar across a face
+        return glm::vec3(p.x * std::sqrt(1.0f - p2.y * 0.5f - p2.z * 0.5f + p2.y * p2.z / 3.0f),
+                         p.y * std::sqrt(1.0f - p2.z * 0.5f - p2.x * 0.5f + p2.z * p2.x / 3.0f),
+                         p.z * std::sqrt(1.0f - p2.x * 0.5f - p2.y * 0.5f + p2.x * p2.y / 3.0f));
+    }
+
+    // Pixels of error if the chunk is drawn instead of its children
+    float screenError(const Node& node, const glm::vec3& cameraPosition, float projectionScale) const {
+        float distance = glm::length(cameraPosition - node.center) - node.boundingRadius - height.amplitude;
+        distance = std::max(distance, 1e-5f);
+        return node.geometricError * projectionScale / distance;
+    }
+
+    // Not entirely behind the horizon
+    bool visible(const Node& node, const glm::vec3& cameraPosition) const {
+        float cameraDistance = glm::length(cameraPosition);
+        float surface = 1.0f - height.amplitude;
+        if (cameraDistance <= surface)
+            return true;
+        float horizon = std::acos(surface / cameraDistance);
+        float angle = std::acos(glm::clamp(glm::dot(node.center, cameraPosition / cameraDistance), -1.0f, 1.0f));
+        return angle - std::asin(std::min(node.boundingRadius, 1.0f)) <= horizon;
+    }
+
+    // Start building a chunk, on a worker when there is a pool
+    void request(Node& node) {
+        if (node.requested)
+            return;
+        node.requested = true;
+        int face = node.face, level = node.level, x = node.x, y = node.y;
+        TerrainHeight height = this->height;
+        float skirt = node.geometricError * 4.0f + height.amplitude * 0.1f;
+        if (pool) {
+            node.pending = pool->enqueue([=] { return buildChunk(face, level, x, y, height, skirt); });
+        }
+        else {
+            std::promise<ChunkMesh> built;
+            built.set_value(buildChunk(face, level, x, y, height, skirt));
+            node.pending = built.get_future();
+        }
+        inFlight.push_back(&node);
+    }
+
+    // Create the children and report whether all of them have meshes
+    bool childrenReady(Node& node, bool requestMissing) {
+        bool ready = true;
+        for (int c = 0; c < 4; ++c) {
+            if (!node.children[c]) {
+                if (!requestMissing)
+                    return false;
+                node.children[c].reset(new Node(node.face, node.level + 1, node.x * 2 + (c & 1), node.y * 2 + (c >> 1)));
+            }
+            request(*node.children[c]);
+            ready = ready && node.children[c]->mesh.valid();
+        }
+        return ready;
+    }
+
+    // Move finished chunks into the arena, a few per frame to keep frame time flat
+    void uploadFinished() {
+        unsigned int uploads = 0;
+        for (size_t i = 0; i < inFlight.size() && uploads < MAX_UPLOADS_PER_FRAME;) {
+            Node* node = inFlight[i];
+            if (node->pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++i;
+                continue;
+            }
+            ChunkMesh chunk = node->pending.get();
+            node->mesh = arena->upload("", chunk.vertices.data(), chunk.vertices.size(), chunk.indices.data(), chunk.indices.size());
+            inFlight[i] = inFlight.back();
+            inFlight.pop_back();
+            ++uploads;
+        }
+    }
+
+    void collapse(Node& node) {
+        for (std::unique_ptr<Node>& child : node.children) {
+            if (!child)
+                continue;
+            release(*child);
+            child.reset();
+        }
+    }
+
+    // Free a subtree. Jobs only hold copies of their parameters, so a chunk still
+    // being built is just forgotten and its result dropped.
+    void release(Node& node) {
+        collapse(node);
+        std::vector<Node*>::iterator pending = std::find(inFlight.begin(), inFlight.end(), &node);
+        if (pending != inFlight.end()) {
+            *pending = inFlight.back();
+            inFlight.pop_back();
+        }
+        arena->release(node.mesh);
+    }
+
+    // Vertices (position, normal, uv) of one chunk plus a skirt along each edge
+    static ChunkMesh buildChunk(int face, int level, int x, int y, const TerrainHeight& height, float skirt) {
+        const int size = GRID + 1;
+        float step = 2.0f / (float)(GRID << level);
+        float a0 = -1.0f + 2.0f * x / (float)(1 << level);
+        float b0 = -1.0f + 2.0f * y / (float)(1 << level);
+
+        // Displaced positions with a one vertex border for the normals
+        std::vector<glm::vec3> positions((size + 2) * (size + 2));
+        for (int j = -1; j <= size; ++j) {
+            for (int i = -1; i <= size; ++i) {
+                glm::vec3 direction = cubeToSphere(face, a0 + i * step, b0 + j * step);
+                positions[(j + 1) * (size + 2) + i + 1] = direction * (1.0f + height(direction));
+            }
+        }
+
+        ChunkMesh chunk;
+        chunk.vertices.reserve((size * size + 4 * size) * MeshArena::FLOATS_PER_VERTEX);
+        for (int j = 0; j < size; ++j) {
+            for (int i = 0; i < size; ++i) {
+                const glm::vec3* p = &positions[(j + 1) * (size + 2) + i + 1];
+                glm::vec3 normal = glm::normalize(glm::cross(p[1] - p[-1], p[size + 2] - p[-(size + 2)]));
+                glm::vec3 direction = glm::normalize(*p);
+                // Same mapping as Object::generateSphere
+                float u = std::atan2(direction.z, direction.x) / 6.2831853f;
+                if (u < 0.0f)
+                    u += 1.0f;
+                float v = std::acos(glm::clamp(direction.y, -1.0f, 1.0f)) / 3.1415927f;
+                pushVertex(chunk.vertices, *p, normal, u, v);
+            }
+        }
+
+        // Chunks straddling u = 0 use u > 1 on one side, the texture repeats
+        float uMin = 1.0f, uMax = 0.0f;
+        for (size_t k = 6; k < chunk.vertices.size(); k += MeshArena::FLOATS_PER_VERTEX) {
+            uMin = std::min(uMin, chunk.vertices[k]);
+            uMax = std::max(uMax, chunk.vertices[k]);
+        }
+        if (uMax - uMin > 0.5f) {
+            for (size_t k = 6; k < chunk.vertices.size(); k += MeshArena::FLOATS_PER_VERTEX)
+                if (chunk.vertices[k] < 0.5f)
+                    chunk.vertices[k] += 1.0f;
+        }
+
+        for (int j = 0; j < GRID; ++j) {
+            for (int i = 0; i < GRID; ++i) {
+                unsigned int i1 = j * size + i;
+                unsigned int i2 = i1 + size;
+                pushTriangle(chunk.indices, i1, i1 + 1, i2);
+                pushTriangle(chunk.indices, i1 + 1, i2 + 1, i2);
+            }
+        }
+
+        // Skirts: each edge repeated below the surface, closing gaps to coarser neighbours
+        static const int edgeStart[4][2] = { { 0, 0 }, { GRID, 0 }, { GRID, GRID }, { 0, GRID } };
+        static const int edgeStep[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+        for (int edge = 0; edge < 4; ++edge) {
+            unsigned int first = (unsigned int)(chunk.vertices.size() / MeshArena::FLOATS_PER_VERTEX);
+            for (int k = 0; k <= GRID; ++k) {
+                int i = edgeStart[edge][0] + edgeStep[edge][0] * k;
+                int j = edgeStart[edge][1] + edgeStep[edge][1] * k;
+                const float* top = &chunk.vertices[(j * size + i) * MeshArena::FLOATS_PER_VERTEX];
+                glm::vec3 position(top[0], top[1], top[2]);
+                pushVertex(chunk.vertices, position * (1.0f - skirt), glm::vec3(top[3], top[4], top[5]), top[6], top[7]);
+                if (k > 0) {
+                    unsigned int topPrevious = (edgeStart[edge][1] + edgeStep[edge][1] * (k - 1)) * size + edgeStart[edge][0] + edgeStep[edge][0] * (k - 1);
+                    unsigned int topCurrent = j * size + i;
+                    pushTriangle(chunk.indices, topPrevious, first + k - 1, topCurrent);
+                    pushTriangle(chunk.indices, topCurrent, first + k - 1, first + k);
+                }
+            }
+        }
+        return chunk;
+    }
+
+    static void pushVertex(std::vector<float>& vertices, const glm::vec3& position, const glm::vec3& normal, float u, float v) {
+        float vertex[8] = { position.x, position.y, position.z, normal.x, normal.y, normal.z, u, v };
+        vertices.insert(vertices.end(), vertex, vertex + 8);
+    }
+
+    static void pushTriangle(std::vector<unsigned int>& indices, unsigned int a, unsigned int b, unsigned int c) {
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(c);
+    }
+};
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef PROCEDURALSPHERE_H
+#define PROCEDURALSPHERE_H
+
+// Tessellation of the unit sphere generated in sphere_vertex_shader.glsl from gl_VertexID.
+// No vertex or index buffers exist, BodyInstances draws it from an empty VAO.
+class ProceduralSphere {
+public:
+    static const unsigned int MIN_SEGMENTS = 12;
+    static const unsigned int MAX_SEGMENTS = 256;
+
+    // About one segment per 1.5 pixels of radius, even so latitude splits evenly
+    static unsigned int segmentsFor(float projectedRadius) {
+        unsigned int segments = (unsigned int)(projectedRadius / 1.5f) & ~1u;
+        if (segments < MIN_SEGMENTS)
+            return MIN_SEGMENTS;
+        return segments > MAX_SEGMENTS ? MAX_SEGMENTS : segments;
+    }
+};
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <limits>
+#include "Shader.h"
+
+// One draw with the state it needs. The queue binds program, vertex array and texture;
+// draw only sets per-draw uniforms and issues the GL call.
+struct DrawPacket {
+    uint64_t key;
+    Shader* shader;
+    unsigned int vertexArray;
+    unsigned int texture;
+    GLenum textureTarget;
+    bool transparent;
+    std::function<void(Shader&)> draw;
+};
+
+// Collects the frame's draws, radix-sorts them by a 64-bit key and submits them
+// without redundant binds. Key layout (most significant first):
+//
+//   opaque:       0 | program:8 | vertex array:8 | texture:16 | depth:24 (front to back)
+//   transparent:  1 | ~depth:24 (back to front) | program:8 | vertex array:8 | texture:16
+//
+// GL names are truncated into their fields, which can only make the order less ideal;
+// the binds themselves always compare the real names.
+class RenderQueue {
+public:
+    static const uint64_t DEPTH_MAX = (1u << 24) - 1;
+
+    // Reserved depth beyond every other packet: a transparent packet here is drawn before all
+    // other transparent ones, whatever the program, vertex array or texture
+    static constexpr float BACKGROUND_DEPTH = std::numeric_limits<float>::infinity();
+
+    // Finite depths are quantized over [0, farDistance] into 0 .. DEPTH_MAX - 1
+    explicit RenderQueue(float farDistance = 100.0f) : farDistance(farDistance), programChanges(0), vertexArrayChanges(0), textureChanges(0) {
+    }
+
+    void submit(Shader& shader, unsigned int vertexArray, unsigned int texture, float depth, bool transparent, const std::function<void(Shader&)>& draw,
+                GLenum textureTarget = GL_TEXTURE_2D) {
+        DrawPacket packet;
+        packet.shader = &shader;
+        packet.vertexArray = vertexArray;
+        packet.texture = texture;
+        packet.textureTarget = textureTarget;
+        packet.transparent = transparent;
+        packet.draw = draw;
+        packet.key = makeKey(shader.ID, vertexArray, texture, quantize(depth), transparent);
+        packets.push_back(packet);
+    }
+
+    // Sort, draw and empty the queue. Transparent packets are blended without depth writes.
+    void flush() {
+        sort();
+        programChanges = vertexArrayChanges = textureChanges = 0;
+        unsigned int currentProgram = 0, currentVertexArray = 0, currentTexture = 0;
+        bool blending = false;
+        for (size_t i = 0; i < order.size(); ++i) {
+            DrawPacket& packet = packets[order[i]];
+            if (packet.transparent != blending) {
+                blending = packet.transparent;
+                if (blending) {
+                    glEnable(GL_BLEND);
+                    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                    glDepthMask(GL_FALSE);
+                }
+                else {
+                    glDisable(GL_BLEND);
+                    glDepthMask(GL_TRUE);
+                }
+            }
+            if (packet.shader->ID != currentProgram) {
+                packet.shader->use();
+                currentProgram = packet.shader->ID;
+                ++programChanges;
+            }
+            if (packet.vertexArray != currentVertexArray) {
+                glBindVertexArray(packet.vertexArray);
+                currentVertexArray = packet.vertexArray;
+                ++vertexArrayChanges;
+            }
+            if (packet.texture && packet.texture != currentTexture) {
+                glBindTexture(packet.textureTarget, packet.texture);
+                currentTexture = packet.texture;
+                ++textureChanges;
+            }
+            packet.draw(*packet.shader);
+        }
+        if (blending) {
+            glDisable(GL_BLEND);
+            glDepthMask(GL_TRUE);
+        }
+        packets.clear();
+    }
+
+    size_t size() const {
+        return packets.size();
+    }
+
+    // State changes made by the last flush
+    unsigned int programChangeCount() const { return programChanges; }
+    unsigned int vertexArrayChangeCount() const { return vertexArrayChanges; }
+    unsigned int textureChangeCount() const { return textureChanges; }
+
+private:
+    float farDistance;
+    std::vector<DrawPacket> packets;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> scratch;
+    unsigned int programChanges;
+    unsigned int vertexArrayChanges;
+    unsigned int textureChanges;
+
+    uint64_t quantize(float depth) const {
+        if (depth == BACKGROUND_DEPTH)
+            return DEPTH_MAX;
+        float t = depth / farDistance;
+        t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        return (uint64_t)(t * (float)(DEPTH_MAX - 1));
+    }
+
+    static uint64_t makeKey(unsigned int program, unsigned int vertexArray, unsigned int texture, uint64_t depth, bool transparent) {
+        uint64_t state = ((uint64_t)(program & 0xFF) << 24) | ((uint64_t)(vertexArray & 0xFF) << 16) | (uint64_t)(texture & 0xFFFF);
+        if (transparent)
+            return (1ull << 63) | ((DEPTH_MAX - depth) << 39) | (state << 7);
+        return (state << 24) | depth;
+    }
+
+    // LSD radix sort of packet indices, 8 bits per pass; passes where every key
+    // has the same byte are skipped, so a frame with few distinct keys sorts in a few passes
+    void sort() {
+        size_t count = packets.size();
+        order.resize(count);
+        scratch.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            order[i] = (uint32_t)i;
+        for (unsigned int shift = 0; shift < 64; shift += 8) {
+            size_t histogram[257] = {};
+            for (size_t i = 0; i < count; ++i)
+                ++histogram[((packets[i].key >> shift) & 0xFF) + 1];
+            bool uniform = false;
+            for (unsigned int b = 1; b <= 256; ++b)
+                uniform = uniform || histogram[b] == count;
+            if (uniform)
+                continue;
+            for (unsigned int b = 1; b <= 256; ++b)
+                histogram[b] += histogram[b - 1];
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t index = order[i];
+                scratch[histogram[(packets[index].key >> shift) & 0xFF]++] = index;
+            }
+            order.swap(scratch);
+        }
+    }
+};
+
+#endif
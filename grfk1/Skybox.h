@@ -0,0 +1,274 @@
+#ifndef SKYBOX_H
+#define SKYBOX_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <stb_image.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "MipGenerator.h"
+#include "StreamBuffer.h"
+#include "TexturePack.h"
+#include "ThreadPool.h"
+
+// Background as a cube map, converted once at load from an equirectangular image (north
+// pole on the top row, u = 0.5 towards -Z) on the thread pool, and drawn as one full-screen
+// triangle on the far plane whose fragments look up the view ray (background_*_shader.glsl).
+//
+// A face of width / 4 texels matches the image's density on average (denser towards the
+// face corners, a little coarser at their centres); it is further capped at the size
+// load() is given, see faceSizeFor. Storage for the whole chain is defined when the
+// conversion is done (storageBytes(), to be counted in the texture budget), then the
+// levels go up coarsest first through the stream buffer as GL_PIXEL_UNPACK_BUFFER, in
+// chunks of rows and about bytesPerFrame per update(), lowering GL_TEXTURE_BASE_LEVEL
+// as every level of all six faces completes.
+class Skybox {
+public:
+    static const int MAX_FACE_SIZE = 2048;
+    static const size_t CHUNK_BYTES = 256 * 1024;
+
+    explicit Skybox(StreamBuffer& stream, size_t bytesPerFrame = 1 << 20)
+        : stream(&stream), bytesPerFrame(bytesPerFrame), texture(0), storage(0), residentLevel(0), face(0), uploadedRows(0) {
+        glGenVertexArrays(1, &VAO);
+    }
+
+    // Largest power of two face (at most MAX_FACE_SIZE) that is no denser than the screen,
+    // where a face spans 90 degrees, and whose chain fits in maxBytes
+    static int faceSizeFor(unsigned int viewportHeight, float fovDegrees, size_t maxBytes) {
+        float needed = (float)viewportHeight / std::tan(glm::radians(fovDegrees) * 0.5f);
+        int size = 1;
+        while (size * 2 <= std::min((float)MAX_FACE_SIZE, needed) && chainBytes(size * 2) <= maxBytes)
+            size *= 2;
+        return size;
+    }
+
+    Skybox(const Skybox&) = delete;
+    Skybox& operator=(const Skybox&) = delete;
+
+    // Start converting path into faces of at most faceSize, from pack when it has the file;
+    // texture is 0 until ready()
+    void load(const std::string& path, ThreadPool& pool, int faceSize = MAX_FACE_SIZE, const TexturePack* pack = nullptr) {
+        ThreadPool* workers = &pool;
+        pending = pool.enqueue([path, workers, faceSize, pack] { return convert(path, workers, faceSize, pack); });
+    }
+
+    // Upload converted levels within this frame's budget, call once per frame on the GL thread
+    void update() {
+        if (pending.valid() && pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            faces = pending.get();
+            if (faces->levels[0].empty()) {
+                faces.reset();
+            }
+            else {
+                glGenTextures(1, &texture);
+                glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+                glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                residentLevel = (int)faces->levels[0].size();
+                face = 0;
+                uploadedRows = 0;
+                for (int level = 0; level < residentLevel; ++level) {
+                    int size = std::max(1, faces->size >> level);
+                    for (int f = 0; f < 6; ++f)
+                        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, level, GL_RGB8, size, size, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+                }
+                storage = chainBytes(faces->size);
+                glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, residentLevel - 1);
+                glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, residentLevel - 1);
+            }
+        }
+        if (!faces)
+            return;
+
+        size_t budget = bytesPerFrame;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        while (residentLevel > 0 && uploadRows(residentLevel - 1, budget)) {
+            uploadedRows = 0;
+            if (++face == 6) {
+                face = 0;
+                --residentLevel;
+                glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+                glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, residentLevel);
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (residentLevel == 0)
+            faces.reset(); // everything is on the GPU
+    }
+
+    // True once the coarsest level of every face is in
+    bool ready() const {
+        return texture && (faces ? residentLevel < (int)faces->levels[0].size() : true);
+    }
+
+    unsigned int cubeMap() const {
+        return texture;
+    }
+
+    // GL storage of the whole chain once defined (RGB8 counted as 4 bytes, like TextureLoader)
+    size_t storageBytes() const {
+        return storage;
+    }
+
+    unsigned int vertexArray() const {
+        return VAO;
+    }
+
+    // Full-screen triangle from gl_VertexID, inverseViewProjection must be set on the background shader
+    void draw() const {
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    // Inverse of projection * view without the camera's translation, the sky is infinitely far
+    static glm::mat4 inverseViewProjection(const glm::mat4& projection, const glm::mat4& view) {
+        return glm::inverse(projection * glm::mat4(glm::mat3(view)));
+    }
+
+    // Waits for a conversion that is still running
+    void destroy() {
+        if (pending.valid())
+            pending.wait();
+        faces.reset();
+        glDeleteTextures(1, &texture);
+        glDeleteVertexArrays(1, &VAO);
+        texture = 0;
+        storage = 0;
+    }
+
+private:
+    struct Faces {
+        int size = 0;
+        std::vector<std::vector<unsigned char>> levels[6]; // mip chain per face, empty when loading failed
+    };
+
+    StreamBuffer* stream;
+    size_t bytesPerFrame;
+    unsigned int VAO;
+    unsigned int texture;
+    size_t storage;
+    std::future<std::shared_ptr<Faces>> pending;
+    std::shared_ptr<Faces> faces; // levels still to upload
+    int residentLevel; // finest level of all faces in the texture
+    int face;          // next face of level residentLevel - 1
+    int uploadedRows;  // of that face
+
+    static size_t chainBytes(int size) {
+        size_t bytes = 0;
+        for (; size > 0; size /= 2)
+            bytes += (size_t)size * size * 4 * 6;
+        return bytes;
+    }
+
+    // Rest of the current face of level, false when the frame's budget or stream space ran out first
+    bool uploadRows(int level, size_t& budget) {
+        int size = std::max(1, faces->size >> level);
+        const std::vector<unsigned char>& pixels = faces->levels[face][level];
+        size_t rowBytes = (size_t)size * 3;
+        int rowsPerChunk = (int)std::max<size_t>(1, CHUNK_BYTES / rowBytes);
+        while (uploadedRows < size) {
+            int rows = std::min(rowsPerChunk, size - uploadedRows);
+            size_t bytes = rows * rowBytes;
+            // A chunk may exceed what is left of the budget only as the first one of the frame
+            if (bytes > budget && budget < bytesPerFrame)
+                return false;
+            size_t offset;
+            void* destination = stream->allocate(bytes, offset);
+            if (!destination)
+                return false;
+            std::memcpy(destination, pixels.data() + uploadedRows * rowBytes, bytes);
+            stream->commit();
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stream->buffer());
+            glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+            glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, 0, uploadedRows, size, rows, GL_RGB, GL_UNSIGNED_BYTE, (void*)offset);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            uploadedRows += rows;
+            budget -= std::min(budget, bytes);
+        }
+        return true;
+    }
+
+    // Worker side: decode, resample every face texel's direction bilinearly (wrapping
+    // horizontally), then build each face's mip chain
+    static std::shared_ptr<Faces> convert(const std::string& path, ThreadPool* workers, int faceSize, const TexturePack* pack) {
+        std::shared_ptr<Faces> result = std::make_shared<Faces>();
+        stbi_set_flip_vertically_on_load_thread(false); // row 0 is the north pole
+        int width, height, channels;
+        unsigned char* data;
+        TexturePack::Blob packed = { nullptr, 0 };
+        if (pack)
+            packed = pack->find(path);
+        if (packed.data)
+            data = stbi_load_from_memory(packed.data, (int)packed.size, &width, &height, &channels, 3);
+        else
+            data = stbi_load(path.c_str(), &width, &height, &channels, 3);
+        if (!data) {
+            std::cerr << "Failed to load texture " << path << std::endl;
+            return result;
+        }
+        int size = 1;
+        int limit = std::min(width / 4, faceSize);
+        if (limit > MAX_FACE_SIZE)
+            limit = MAX_FACE_SIZE;
+        while (size * 2 <= limit)
+            size *= 2;
+        result->size = size;
+
+        std::vector<std::vector<unsigned char>> pixels(6, std::vector<unsigned char>((size_t)size * size * 3));
+        workers->parallelFor((size_t)6 * size, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t row = begin; row < end; ++row) {
+                int face = (int)(row / size), y = (int)(row % size);
+                for (int x = 0; x < size; ++x) {
+                    glm::vec3 direction = faceDirection(face, (2.0f * x + 1.0f) / size - 1.0f, (2.0f * y + 1.0f) / size - 1.0f);
+                    sample(data, width, height, glm::normalize(direction), &pixels[face][((size_t)y * size + x) * 3]);
+                }
+            }
+        });
+        stbi_image_free(data);
+        for (int face = 0; face < 6; ++face)
+            result->levels[face] = MipGenerator::build(std::move(pixels[face]), size, size, 3, MipGenerator::KAISER, workers);
+        return result;
+    }
+
+    // Direction of face coordinates sc, tc in [-1, 1] (row 0 is tc = -1), as GL looks cube maps up
+    static glm::vec3 faceDirection(int face, float sc, float tc) {
+        switch (face) {
+        case 0: return glm::vec3(1.0f, -tc, -sc);  // +X
+        case 1: return glm::vec3(-1.0f, -tc, sc);  // -X
+        case 2: return glm::vec3(sc, 1.0f, tc);    // +Y
+        case 3: return glm::vec3(sc, -1.0f, -tc);  // -Y
+        case 4: return glm::vec3(sc, -tc, 1.0f);   // +Z
+        default: return glm::vec3(-sc, -tc, -1.0f); // -Z
+        }
+    }
+
+    static void sample(const unsigned char* image, int width, int height, const glm::vec3& direction, unsigned char* out) {
+        const float pi = 3.14159265358979f;
+        float u = std::atan2(direction.x, -direction.z) / (2.0f * pi) + 0.5f;
+        float v = std::acos(std::max(-1.0f, std::min(1.0f, direction.y))) / pi;
+        float x = u * width - 0.5f, y = std::max(0.0f, std::min(height - 1.0f, v * height - 0.5f));
+        int x0 = (int)std::floor(x), y0 = (int)y;
+        float fx = x - (float)x0, fy = y - (float)y0;
+        int y1 = std::min(y0 + 1, height - 1);
+        x0 = (x0 % width + width) % width;
+        int x1 = (x0 + 1) % width;
+        const unsigned char* p00 = &image[((size_t)y0 * width + x0) * 3];
+        const unsigned char* p01 = &image[((size_t)y0 * width + x1) * 3];
+        const unsigned char* p10 = &image[((size_t)y1 * width + x0) * 3];
+        const unsigned char* p11 = &image[((size_t)y1 * width + x1) * 3];
+        for (int c = 0; c < 3; ++c) {
+            float top = p00[c] + (p01[c] - p00[c]) * fx, bottom = p10[c] + (p11[c] - p10[c]) * fx;
+            out[c] = (unsigned char)(top + (bottom - top) * fy + 0.5f);
+        }
+    }
+};
+
+#endif
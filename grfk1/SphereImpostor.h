@@ -0,0 +1,38 @@
+#ifndef SPHEREIMPOSTOR_H
+#define SPHEREIMPOSTOR_H
+
+#include <glad/glad.h>
+
+// Bodies smaller than this on screen (radius in pixels) are drawn as impostors
+const float IMPOSTOR_MAX_RADIUS = 16.0f;
+
+// Sphere drawn as one camera-facing quad from impostor_vertex_shader.glsl; the fragment
+// shader built with IMPOSTOR ray-traces the sphere and writes its real depth.
+class SphereImpostor {
+public:
+    SphereImpostor() {
+        glGenVertexArrays(1, &VAO);
+    }
+
+    void destroy() {
+        glDeleteVertexArrays(1, &VAO);
+    }
+
+    void bind() const {
+        glBindVertexArray(VAO);
+    }
+
+    unsigned int vertexArray() const {
+        return VAO;
+    }
+
+    // Draw one body, model must be set on the impostor shader
+    void draw() const {
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+private:
+    unsigned int VAO;
+};
+
+#endif
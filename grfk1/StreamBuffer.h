@@ -0,0 +1,168 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <glad/glad.h>
+#include <cstring>
+#include <string>
+#include <iostream>
+
+// ARB_buffer_storage is not part of the GL 3.3 loader
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+// Ring buffer for data written by the CPU every frame. With ARB_buffer_storage the
+// whole buffer is mapped once (persistent, coherent) and split into FRAMES regions;
+// a fence per region keeps the CPU from overwriting data the GPU may still read.
+// On plain GL 3.3 it appends with unsynchronized glMapBufferRange and orphans the
+// buffer when it wraps, which lets the driver hand out fresh memory without a stall.
+class StreamBuffer {
+public:
+    static const unsigned int FRAMES = 3;
+    static const size_t ALIGNMENT = 64;
+
+    // Look up glBufferStorage, call once after gladLoadGLLoader
+    static void loadExtensions(GLADloadproc load) {
+        bool supported = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount && !supported; ++i)
+            supported = std::strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_buffer_storage") == 0;
+        bufferStorage() = supported ? (BufferStorageProc)load("glBufferStorage") : nullptr;
+    }
+
+    explicit StreamBuffer(size_t bytesPerFrame) : frameSize(align(bytesPerFrame)), frame(0), head(0), mapped(nullptr) {
+        for (unsigned int f = 0; f < FRAMES; ++f)
+            fences[f] = 0;
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_COPY_READ_BUFFER, ID);
+        if (bufferStorage()) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            bufferStorage()(GL_COPY_READ_BUFFER, frameSize * FRAMES, NULL, flags);
+            mapped = (unsigned char*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, frameSize * FRAMES, flags);
+            if (!mapped)
+                std::cerr << "ERROR::STREAMBUFFER::PERSISTENT_MAP_FAILED" << std::endl;
+        }
+        if (!mapped) {
+            // Fallback: an ordinary buffer, storage from glBufferStorage would be immutable
+            glDeleteBuffers(1, &ID);
+            glGenBuffers(1, &ID);
+            glBindBuffer(GL_COPY_READ_BUFFER, ID);
+            glBufferData(GL_COPY_READ_BUFFER, frameSize * FRAMES, NULL, GL_STREAM_DRAW);
+        }
+    }
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    void destroy() {
+        for (unsigned int f = 0; f < FRAMES; ++f)
+            if (fences[f])
+                glDeleteSync(fences[f]);
+        if (mapped) {
+            glBindBuffer(GL_COPY_READ_BUFFER, ID);
+            glUnmapBuffer(GL_COPY_READ_BUFFER);
+        }
+        glDeleteBuffers(1, &ID);
+    }
+
+    // Space for size bytes in the current frame, offset receives the position in buffer().
+    // Returns nullptr when the frame's region is full. Finish writing with commit().
+    void* allocate(size_t size, size_t& offset) {
+        size = align(size);
+        if (size > frameSize)
+            return nullptr;
+        if (mapped) {
+            if (head + size > (frame + 1) * frameSize)
+                return nullptr;
+            offset = head;
+            head += size;
+            return mapped + offset;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, ID);
+        if (head + size > frameSize * FRAMES) {
+            glBufferData(GL_COPY_READ_BUFFER, frameSize * FRAMES, NULL, GL_STREAM_DRAW);
+            head = 0;
+        }
+        offset = head;
+        head += size;
+        return glMapBufferRange(GL_COPY_READ_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+
+    // Make the data from the last allocate visible to GL
+    void commit() {
+        if (mapped)
+            return;
+        glBindBuffer(GL_COPY_READ_BUFFER, ID);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+    }
+
+    // Copy into another buffer through the ring with glCopyBufferSubData, so the target
+    // buffer is never written by the CPU while draws may read it. Falls back to
+    // glBufferSubData when the frame's region is full.
+    void upload(GLuint buffer, size_t bufferOffset, const void* data, size_t size) {
+        if (size == 0)
+            return;
+        size_t offset;
+        void* destination = allocate(size, offset);
+        if (!destination) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, bufferOffset, size, data);
+            return;
+        }
+        std::memcpy(destination, data, size);
+        commit();
+        glBindBuffer(GL_COPY_READ_BUFFER, ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, bufferOffset, size);
+    }
+
+    // Call once per frame after the last draw that reads this frame's data
+    void endFrame() {
+        if (!mapped)
+            return;
+        fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        frame = (frame + 1) % FRAMES;
+        head = frame * frameSize;
+        if (fences[frame]) {
+            // Only blocks when the GPU is more than FRAMES - 1 frames behind
+            while (glClientWaitSync(fences[frame], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {
+            }
+            glDeleteSync(fences[frame]);
+            fences[frame] = 0;
+        }
+    }
+
+    GLuint buffer() const {
+        return ID;
+    }
+
+    // True when using persistent mapping, false for the orphaning fallback
+    bool persistent() const {
+        return mapped != nullptr;
+    }
+
+private:
+    typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+    GLuint ID;
+    size_t frameSize;
+    unsigned int frame;
+    size_t head;
+    unsigned char* mapped;
+    GLsync fences[FRAMES];
+
+    static BufferStorageProc& bufferStorage() {
+        static BufferStorageProc proc = nullptr;
+        return proc;
+    }
+
+    static size_t align(size_t value) {
+        return (value + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+};
+
+#endif
@@ -1,43 +1,125 @@
-#ifndef TEXTURE_H
-#define TEXTURE_H
-
-#include <glad/glad.h>
-#include <stb_image.h>
-#include <iostream>
-
-class Texture {
-public:
-    unsigned int ID;
-
-    // Constructor loading the texture
-    Texture(const char* texturePath) {
-        glGenTextures(1, &ID);
-        glBindTexture(GL_TEXTURE_2D, ID);
-
-        // Texture settings
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // Load image
-        int width, height, nrChannels;
-        stbi_set_flip_vertically_on_load(true); // Flip textures vertically
-        unsigned char* data = stbi_load(texturePath, &width, &height, &nrChannels, 0);
-        if (data) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else {
-            std::cerr << "Failed to load texture" << std::endl;
-        }
-        stbi_image_free(data);
-    }
-
-    // Activate texture
-    void bind() const {
-        glBindTexture(GL_TEXTURE_2D, ID);
-    }
-};
-
-#endif
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "CompressedTexture.h"
+#include "MipGenerator.h"
+
+class TextureLoader;
+
+// Wrap and filter modes of a texture, part of the TextureCache key
+struct TextureSampler {
+    GLenum wrap = GL_REPEAT;
+    GLenum minFilter = GL_LINEAR;
+    GLenum magFilter = GL_LINEAR;
+
+    bool operator<(const TextureSampler& other) const {
+        if (wrap != other.wrap)
+            return wrap < other.wrap;
+        if (minFilter != other.minFilter)
+            return minFilter < other.minFilter;
+        return magFilter < other.magFilter;
+    }
+
+    // Set on the bound GL_TEXTURE_2D
+    void apply() const {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+    }
+};
+
+class Texture {
+public:
+    unsigned int ID;
+    TextureSampler sampler;
+
+    // Empty texture for a TextureLoader, ID is a shared 1x1 placeholder until the image is resident
+    explicit Texture(const TextureSampler& sampler = TextureSampler()) : ID(placeholder()), sampler(sampler), resident(false) {
+    }
+
+    // Constructor loading the texture
+    Texture(const char* texturePath, const TextureSampler& sampler = TextureSampler()) : sampler(sampler), resident(false) {
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D, ID);
+
+        // Texture settings
+        sampler.apply();
+
+        // Pre-mipped BC1/BC3 file from tools/texcook when there is one and the driver has S3TC
+        CompressedTexture cooked;
+        if (CompressedTexture::supported() && cooked.open(CompressedTexture::cookedPath(texturePath))) {
+            cooked.upload();
+            resident = true;
+            return;
+        }
+
+        // Load image
+        int width, height, nrChannels;
+        stbi_set_flip_vertically_on_load(true); // Flip textures vertically
+        unsigned char* data = stbi_load(texturePath, &width, &height, &nrChannels, 0);
+        if (data) {
+            // Keep the alpha channel (e.g. the ring texture), a 4-channel image read as RGB is skewed
+            GLenum format = nrChannels == 4 ? GL_RGBA : nrChannels == 1 ? GL_RED : GL_RGB;
+            // Mipmapy liczone na CPU w przestrzeni liniowej, wszystkie poziomy wysylane od razu
+            std::vector<std::vector<unsigned char>> levels = MipGenerator::build(
+                std::vector<unsigned char>(data, data + (size_t)width * height * nrChannels), width, height, nrChannels);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (size_t level = 0; level < levels.size(); ++level) {
+                glTexImage2D(GL_TEXTURE_2D, (GLint)level, format, width, height, 0, format, GL_UNSIGNED_BYTE, levels[level].data());
+                width = std::max(1, width / 2);
+                height = std::max(1, height / 2);
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            resident = true;
+        }
+        else {
+            std::cerr << "Failed to load texture" << std::endl;
+        }
+        stbi_image_free(data);
+    }
+
+    // Activate texture
+    void bind() const {
+        glBindTexture(GL_TEXTURE_2D, ID);
+    }
+
+    // False while the image is still being loaded (or failed to load)
+    bool ready() const {
+        return resident;
+    }
+
+    // Delete the image and go back to the placeholder
+    void release() {
+        if (ID != placeholder())
+            glDeleteTextures(1, &ID);
+        ID = placeholder();
+        resident = false;
+    }
+
+private:
+    friend class TextureLoader;
+
+    bool resident;
+
+    // Mid-grey 1x1 texture shared by every texture that is not loaded yet
+    static unsigned int placeholder() {
+        static unsigned int name = 0;
+        if (!name) {
+            const unsigned char grey[4] = { 128, 128, 128, 255 };
+            glGenTextures(1, &name);
+            glBindTexture(GL_TEXTURE_2D, name);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        }
+        return name;
+    }
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef TEXTUREARRAY_H
+#define TEXTUREARRAY_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include "MipGenerator.h"
+
+class TextureLoader;
+
+// Several images in one GL_TEXTURE_2D_ARRAY, layer i = paths[i]. Images of another
+// size are resampled to width x height (box filter when shrinking, bilinear when growing).
+class TextureArray {
+public:
+    unsigned int ID;
+
+    TextureArray(const std::vector<std::string>& paths, int width, int height)
+        : layers((int)paths.size()), arrayWidth(width), arrayHeight(height), resident(true) {
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        int levelCount = 1;
+        for (int levelWidth = width, levelHeight = height; levelWidth > 1 || levelHeight > 1; ++levelCount) {
+            levelWidth = std::max(1, levelWidth / 2);
+            levelHeight = std::max(1, levelHeight / 2);
+        }
+        for (int level = 0; level < levelCount; ++level)
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGB8, std::max(1, width >> level), std::max(1, height >> level), layers, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        stbi_set_flip_vertically_on_load(true); // Same orientation as Texture
+        for (int layer = 0; layer < layers; ++layer) {
+            int imageWidth, imageHeight, channels;
+            unsigned char* data = stbi_load(paths[layer].c_str(), &imageWidth, &imageHeight, &channels, 3);
+            if (!data) {
+                std::cerr << "Failed to load texture " << paths[layer] << std::endl;
+                continue;
+            }
+            std::vector<unsigned char> pixels;
+            if (imageWidth == width && imageHeight == height)
+                pixels.assign(data, data + (size_t)width * height * 3);
+            else
+                pixels = resample(data, imageWidth, imageHeight, width, height);
+            stbi_image_free(data);
+            // Every level of the layer from the CPU mip chain (linear-space filtering)
+            std::vector<std::vector<unsigned char>> levels = MipGenerator::build(std::move(pixels), width, height, 3);
+            for (int level = 0; level < levelCount; ++level)
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, std::max(1, width >> level), std::max(1, height >> level), 1, GL_RGB, GL_UNSIGNED_BYTE, levels[level].data());
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    // Layers filled later by a TextureLoader; until every layer has its preview ID is a 1x1 grey array
+    TextureArray(int layers, int width, int height)
+        : layers(layers), arrayWidth(width), arrayHeight(height), resident(false) {
+        std::vector<unsigned char> grey((size_t)layers * 3, 128);
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, 1, 1, layers, 0, GL_RGB, GL_UNSIGNED_BYTE, grey.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    void bind() const {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    }
+
+    int layerCount() const {
+        return layers;
+    }
+
+    int width() const {
+        return arrayWidth;
+    }
+
+    int height() const {
+        return arrayHeight;
+    }
+
+    // False while a TextureLoader is still filling the layers
+    bool ready() const {
+        return resident;
+    }
+
+    // Separable RGB resample, one axis at a time through a float buffer
+    static std::vector<unsigned char> resample(const unsigned char* source, int sourceWidth, int sourceHeight, int width, int height) {
+        std::vector<float> image(source, source + (size_t)sourceWidth * sourceHeight * 3);
+        std::vector<float> rows = resampleAxis(image, sourceWidth, sourceHeight, width, true);
+        std::vector<float> result = resampleAxis(rows, width, sourceHeight, height, false);
+        std::vector<unsigned char> bytes(result.size());
+        for (size_t i = 0; i < result.size(); ++i)
+            bytes[i] = (unsigned char)(result[i] < 0.0f ? 0.0f : (result[i] > 255.0f ? 255.0f : result[i] + 0.5f));
+        return bytes;
+    }
+
+private:
+    friend class TextureLoader;
+
+    int layers;
+    int arrayWidth, arrayHeight;
+    bool resident;
+
+    static std::vector<float> resampleAxis(const std::vector<float>& image, int width, int height, int size, bool horizontal) {
+        int sourceSize = horizontal ? width : height;
+        int lines = horizontal ? height : width;
+        std::vector<float> result((size_t)(horizontal ? size * height : width * size) * 3);
+        float scale = (float)sourceSize / (float)size;
+        for (int line = 0; line < lines; ++line) {
+            for (int i = 0; i < size; ++i) {
+                float sum[3] = { 0.0f, 0.0f, 0.0f };
+                float weight = 0.0f;
+                if (scale > 1.0f) {
+                    // Average every source texel in the footprint
+                    int first = (int)(i * scale), last = std::max(first + 1, (int)((i + 1) * scale));
+                    for (int s = first; s < last && s < sourceSize; ++s) {
+                        const float* texel = &image[texelIndex(s, line, width, horizontal)];
+                        for (int c = 0; c < 3; ++c)
+                            sum[c] += texel[c];
+                        weight += 1.0f;
+                    }
+                }
+                else {
+                    float position = (i + 0.5f) * scale - 0.5f;
+                    int s0 = std::max(0, std::min(sourceSize - 1, (int)std::floor(position)));
+                    int s1 = std::min(sourceSize - 1, s0 + 1);
+                    float t = std::max(0.0f, std::min(1.0f, position - (float)s0));
+                    const float* a = &image[texelIndex(s0, line, width, horizontal)];
+                    const float* b = &image[texelIndex(s1, line, width, horizontal)];
+                    for (int c = 0; c < 3; ++c)
+                        sum[c] = a[c] + (b[c] - a[c]) * t;
+                    weight = 1.0f;
+                }
+                float* out = &result[horizontal ? ((size_t)line * size + i) * 3 : ((size_t)i * width + line) * 3];
+                for (int c = 0; c < 3; ++c)
+                    out[c] = sum[c] / weight;
+            }
+        }
+        return result;
+    }
+
+    static size_t texelIndex(int s, int line, int width, bool horizontal) {
+        return horizontal ? ((size_t)line * width + s) * 3 : ((size_t)s * width + line) * 3;
+    }
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+#include <climits>
+#include "Texture.h"
+#include "TextureLoader.h"
+
+struct TextureCacheStats {
+    unsigned int requests = 0;
+    unsigned int hits = 0;
+    unsigned int loads = 0;
+    unsigned int evictions = 0;
+};
+
+// Shared textures keyed by canonical path and sampler settings. Every path is decoded
+// once; callers hold shared_ptr handles and the GL texture is deleted with the last one.
+// The cache itself keeps a reference until the entry is evicted, so textures survive
+// being unused for a while.
+class TextureCache {
+public:
+    typedef std::shared_ptr<Texture> Handle;
+
+    // With a loader textures load in the background, otherwise synchronously
+    explicit TextureCache(TextureLoader* loader = nullptr) : loader(loader) {
+    }
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    Handle acquire(const std::string& path, const TextureSampler& sampler = TextureSampler()) {
+        ++stats.requests;
+        Key key(canonicalPath(path), sampler);
+        std::map<Key, Handle>::iterator it = entries.find(key);
+        if (it != entries.end()) {
+            ++stats.hits;
+            return it->second;
+        }
+        ++stats.loads;
+        Handle texture;
+        if (loader) {
+            TextureLoader* owner = loader;
+            texture = Handle(new Texture(sampler), [owner](Texture* t) {
+                // The loader may still be streaming mips into it
+                owner->forget(*t);
+                release(t);
+            });
+            loader->load(*texture, key.first);
+        }
+        else {
+            texture = Handle(new Texture(key.first.c_str(), sampler), release);
+        }
+        entries[key] = texture;
+        return texture;
+    }
+
+    // Forget one entry; the texture lives on while handles to it remain
+    bool evict(const std::string& path, const TextureSampler& sampler = TextureSampler()) {
+        std::map<Key, Handle>::iterator it = entries.find(Key(canonicalPath(path), sampler));
+        if (it == entries.end())
+            return false;
+        entries.erase(it);
+        ++stats.evictions;
+        return true;
+    }
+
+    // Forget every entry nobody else holds, returns how many textures were deleted
+    size_t evictUnused() {
+        size_t evicted = 0;
+        for (std::map<Key, Handle>::iterator it = entries.begin(); it != entries.end();) {
+            if (it->second.use_count() == 1) {
+                it = entries.erase(it);
+                ++evicted;
+            }
+            else {
+                ++it;
+            }
+        }
+        stats.evictions += (unsigned int)evicted;
+        return evicted;
+    }
+
+    // Drop everything, must run while the context is alive and after the loader is destroyed
+    void clear() {
+        entries.clear();
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    const TextureCacheStats& statistics() const {
+        return stats;
+    }
+
+    // Absolute path with one kind of separator, so "textures/a.bmp" and ".\\textures\\a.bmp" match
+    static std::string canonicalPath(const std::string& path) {
+        std::string result = path;
+#ifdef _WIN32
+        char buffer[_MAX_PATH];
+        if (_fullpath(buffer, path.c_str(), _MAX_PATH))
+            result = buffer;
+#else
+        char buffer[PATH_MAX];
+        if (realpath(path.c_str(), buffer))
+            result = buffer;
+#endif
+        for (char& c : result)
+            if (c == '\\')
+                c = '/';
+        return result;
+    }
+
+private:
+    typedef std::pair<std::string, TextureSampler> Key;
+
+    TextureLoader* loader;
+    std::map<Key, Handle> entries;
+    TextureCacheStats stats;
+
+    static void release(Texture* texture) {
+        texture->release();
+        delete texture;
+    }
+};
+
+#endif
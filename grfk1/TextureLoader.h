@@ -0,0 +1,669 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <iterator>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include "Texture.h"
+#include "TextureArray.h"
+#include "CompressedTexture.h"
+#include "MipGenerator.h"
+#include "TexturePack.h"
+#include "StreamBuffer.h"
+#include "ThreadPool.h"
+
+struct TextureBudgetStats {
+    size_t budget = 0;        // 0 = unlimited
+    size_t residentBytes = 0; // storage of every defined level, placeholders and reserved storage
+    size_t reservedBytes = 0; // of that, reported with reserve() by textures the loader does not stream
+    size_t peakBytes = 0;
+    unsigned int droppedLevels = 0; // freed to make room
+    unsigned int evictions = 0;     // textures back to their placeholder
+    unsigned int reloads = 0;       // decodes started again for dropped detail
+    unsigned int deniedFrames = 0;  // frames a requested level did not fit
+};
+
+// Decodes images on the thread pool and uploads them on the GL thread through the stream
+// buffer bound as GL_PIXEL_UNPACK_BUFFER, a few rows per chunk and at most bytesPerFrame
+// per update(). Files found in a TexturePack are decoded straight from its mapping, without opening them.
+// Images that are not cooked get their mip chain from MipGenerator on the workers too.
+//
+// Mip levels go up coarsest first into a new texture object. GL_TEXTURE_MAX_LEVEL stays at
+// the coarsest level and GL_TEXTURE_BASE_LEVEL is lowered after each complete level, so a
+// level is never sampled half uploaded and finer levels get no storage until they are
+// needed. The object replaces the placeholder once the levels up to PREVIEW_SIZE are in
+// (every texture gets its preview before any is refined); finer levels follow only as far
+// as request() asks for.
+//
+// With setBudget() the bytes of all texture storage stay under a limit: every level the loader
+// defined, the placeholders, and storage other owners report with reserve() (the virtual
+// texture caches, the sky), which only shrinks what is left for streamed levels. A level that
+// would not fit first takes the finest levels of the textures requested longest ago (down
+// to their previews), then textures (not arrays) unused for EVICT_FRAMES, which go back to
+// their placeholder; textures requested this frame are never touched. Decoded images are
+// freed once all levels of a texture are resident, so detail that comes back is decoded again.
+class TextureLoader {
+public:
+    static const size_t CHUNK_BYTES = 256 * 1024;
+    static const int PREVIEW_SIZE = 128; // longest side of the first level shown
+    static const unsigned int EVICT_FRAMES = 600; // unused this long, a texture may lose its preview too
+
+    TextureLoader(ThreadPool& pool, StreamBuffer& stream, size_t bytesPerFrame = 1 << 20)
+        : pool(&pool), stream(&stream), bytesPerFrame(bytesPerFrame) {
+    }
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // Filter of the mip chains built for textures that are not cooked
+    void setMipFilter(MipGenerator::Filter filter) {
+        mipFilter = filter;
+    }
+
+    // Limit on the bytes of texture storage, 0 = unlimited
+    void setBudget(size_t bytes) {
+        stats.budget = bytes;
+    }
+
+    const TextureBudgetStats& budgetStatistics() const {
+        return stats;
+    }
+
+    // Count storage allocated outside the loader against the budget, unreserve() when it is freed
+    void reserve(size_t bytes) {
+        stats.reservedBytes += bytes;
+        stats.residentBytes += bytes;
+        stats.peakBytes = std::max(stats.peakBytes, stats.residentBytes);
+    }
+
+    void unreserve(size_t bytes) {
+        stats.reservedBytes -= std::min(stats.reservedBytes, bytes);
+        stats.residentBytes -= std::min(stats.residentBytes, bytes);
+    }
+
+    // Serve the files it contains from texturePack, which must outlive the loader's jobs
+    void setPack(const TexturePack* texturePack) {
+        pack = texturePack;
+    }
+
+    // Start loading path into texture, which keeps its placeholder until ready()
+    void load(Texture& texture, const std::string& path) {
+        if (!placeholderCounted) {
+            placeholderCounted = true;
+            reserve(4); // the 1x1 RGBA shared by every Texture
+        }
+        streams.push_back(Stream());
+        Stream& target = streams.back();
+        target.texture = &texture;
+        target.paths.push_back(path);
+        target.layers.resize(1);
+        startDecode(target, 0);
+    }
+
+    // Start loading path into one layer of an array made with TextureArray(layers, width, height),
+    // resampled to the array size on the worker. The array is shown once every layer has its preview.
+    void loadLayer(TextureArray& array, int layer, const std::string& path) {
+        Stream* target = find(nullptr, &array);
+        if (!target) {
+            streams.push_back(Stream());
+            target = &streams.back();
+            target->array = &array;
+            target->paths.resize(array.layerCount());
+            target->layers.resize(array.layerCount());
+            target->decodeChannels = 3;
+            target->decodeWidth = array.width();
+            target->decodeHeight = array.height();
+            reserve((size_t)array.layerCount() * 4); // the grey 1x1 array, RGB8 counted as 4 bytes
+        }
+        target->paths[layer] = path;
+        startDecode(*target, layer);
+    }
+
+    // Finest detail the texture is needed at this frame, in texels across its width (for a
+    // sphere 2 pi times its projected radius). The largest request of a frame decides how
+    // far the texture is refined; one nobody asks for stays at its preview levels. Requests
+    // also mark the texture as in use for the budget.
+    void request(const Texture& texture, float texels) {
+        request(find(&texture, nullptr), texels);
+    }
+
+    void request(const TextureArray& array, float texels) {
+        request(find(nullptr, &array), texels);
+    }
+
+    // Upload decoded levels within this frame's budget, call once per frame on the GL thread
+    void update() {
+        for (std::list<Decode>::iterator it = decodes.begin(); it != decodes.end();) {
+            if (it->image.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+            Stream* target = it->stream;
+            size_t layer = it->layer;
+            std::shared_ptr<Image> image = it->image.get();
+            --target->decoding;
+            it = decodes.erase(it);
+            if (image->levels.empty()) {
+                std::cerr << "Failed to load texture " << target->paths[layer] << std::endl;
+                if (target->texture && target->shown) {
+                    // Keep the levels it has, finer ones cannot come back
+                    target->finestLevel = target->targetLevel = target->residentLevel;
+                    continue;
+                }
+                if (target->texture) {
+                    erase(target);
+                    continue;
+                }
+                // The array still needs every layer, a failed one stays grey
+                image = greyImage(target->decodeWidth, target->decodeHeight);
+            }
+            target->layers[layer] = image;
+            ++target->decodedLayers;
+        }
+
+        for (Stream& target : streams) {
+            if (target.requestedTexels > 0.0f && !target.shape.empty())
+                target.targetLevel = std::max(levelFor(target, target.requestedTexels), target.finestLevel);
+            target.requestedTexels = 0.0f;
+            // Detail whose decoded image was freed is decoded again
+            if (wanted(target) && target.decoding == 0 && target.decodedLayers < target.layers.size()) {
+                for (size_t layer = 0; layer < target.layers.size(); ++layer)
+                    if (!target.layers[layer])
+                        startDecode(target, layer);
+                ++stats.reloads;
+            }
+        }
+        if (stats.budget && stats.residentBytes > stats.budget)
+            makeRoom(0, nullptr);
+
+        size_t budget = bytesPerFrame;
+        denied = false;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        // Previews first, then the requested levels
+        for (int pass = 0; pass < 2; ++pass) {
+            for (Stream& target : streams) {
+                if (target.decodedLayers < target.layers.size() || target.shown != (pass == 1) || !wanted(target))
+                    continue;
+                if (!target.name)
+                    begin(target);
+                if (!target.shown) {
+                    if (uploadLevels(target, target.previewLevel, budget))
+                        show(target);
+                }
+                else if (uploadLevels(target, target.targetLevel, budget) && target.residentLevel == 0) {
+                    // Every level is on the GPU, the decoded image is no longer needed
+                    freeImages(target);
+                }
+            }
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (denied)
+            ++stats.deniedFrames;
+        ++frame;
+    }
+
+    // Images still decoding, not shown yet or short of their requested levels
+    size_t pendingCount() const {
+        size_t pending = decodes.size();
+        for (const Stream& target : streams)
+            if (wanted(target))
+                ++pending;
+        return pending;
+    }
+
+    bool idle() const {
+        return pendingCount() == 0;
+    }
+
+    // Stop streaming into a texture that is about to be deleted
+    void forget(const Texture& texture) {
+        Stream* target = find(&texture, nullptr);
+        if (!target)
+            return;
+        for (std::list<Decode>::iterator it = decodes.begin(); it != decodes.end();)
+            it = it->stream == target ? decodes.erase(it) : std::next(it);
+        erase(target);
+    }
+
+    // Drop unfinished uploads, waits for decodes that are still running
+    void destroy() {
+        for (Decode& job : decodes)
+            if (job.image.valid())
+                job.image.wait();
+        decodes.clear();
+        for (Stream& target : streams)
+            if (target.name && !target.shown)
+                glDeleteTextures(1, &target.name);
+        streams.clear();
+        stats.residentBytes = 0;
+        stats.reservedBytes = 0;
+        placeholderCounted = false;
+    }
+
+private:
+    // One mip level, rows are pixel rows or rows of 4x4 blocks for cooked files
+    struct Level {
+        int width;
+        int height;
+        const unsigned char* data;
+        size_t size;
+        int rows;
+    };
+
+    struct Image {
+        std::vector<std::vector<unsigned char>> pixels; // decoded mip chain
+        std::shared_ptr<CompressedTexture> cooked; // instead of pixels for textures cooked by tools/texcook
+        int channels = 0;
+        std::vector<Level> levels; // empty when decoding failed
+    };
+
+    // A texture or array filled level by level from the coarsest, kept while it lives
+    struct Stream {
+        Texture* texture = nullptr;
+        TextureArray* array = nullptr;
+        std::vector<std::string> paths; // per layer
+        int decodeChannels = 0;         // arguments of decode(), arrays resample to their size
+        int decodeWidth = 0;
+        int decodeHeight = 0;
+        std::vector<std::shared_ptr<Image>> layers; // null once freed
+        size_t decodedLayers = 0;
+        size_t decoding = 0;
+        unsigned int name = 0; // texture object being filled
+        bool shown = false;    // name replaced the placeholder
+        bool evicted = false;  // back on the placeholder, loads again when requested
+        std::vector<Level> shape; // level sizes, known after the first decode
+        GLenum compressedFormat = 0;
+        int channels = 0;
+        int levelCount = 0;
+        int previewLevel = 0;
+        int finestLevel = 0;   // finer levels failed to decode again
+        int targetLevel = 0;   // finest level wanted
+        int residentLevel = 0; // finest complete level, levelCount while there is none
+        float requestedTexels = 0.0f;
+        unsigned int lastUse = 0; // frame of the last request
+        size_t bytes = 0;         // storage of its defined levels
+        bool levelDefined = false; // level residentLevel - 1 has storage
+        size_t layer = 0;          // progress within level residentLevel - 1
+        int uploadedRows = 0;
+    };
+
+    struct Decode {
+        Stream* stream;
+        size_t layer;
+        std::future<std::shared_ptr<Image>> image;
+    };
+
+    ThreadPool* pool;
+    StreamBuffer* stream;
+    size_t bytesPerFrame;
+    const TexturePack* pack = nullptr;
+    MipGenerator::Filter mipFilter = MipGenerator::KAISER;
+    std::list<Stream> streams;
+    std::list<Decode> decodes;
+    TextureBudgetStats stats;
+    unsigned int frame = 1;
+    bool denied = false; // a level did not fit this frame
+    bool placeholderCounted = false;
+
+    void request(Stream* target, float texels) {
+        if (!target)
+            return;
+        target->requestedTexels = std::max(target->requestedTexels, texels);
+        target->lastUse = frame;
+    }
+
+    // Levels to upload: the preview of a new (or evicted and requested) texture, or requested detail
+    bool wanted(const Stream& target) const {
+        if (!target.shown)
+            return !target.evicted || target.lastUse == frame;
+        return target.residentLevel > target.targetLevel;
+    }
+
+    Stream* find(const Texture* texture, const TextureArray* array) {
+        for (Stream& target : streams)
+            if ((texture && target.texture == texture) || (array && target.array == array))
+                return &target;
+        return nullptr;
+    }
+
+    void erase(Stream* target) {
+        for (std::list<Stream>::iterator it = streams.begin(); it != streams.end(); ++it) {
+            if (&*it == target) {
+                // A shown texture is deleted by its owner
+                stats.residentBytes -= target->bytes;
+                if (target->name && !target->shown)
+                    glDeleteTextures(1, &target->name);
+                streams.erase(it);
+                return;
+            }
+        }
+    }
+
+    void startDecode(Stream& target, size_t layer) {
+        std::string path = target.paths[layer];
+        int channels = target.decodeChannels, width = target.decodeWidth, height = target.decodeHeight;
+        if (pack) {
+            // Page the packed files in while the job waits for a worker
+            pack->prefetch(path);
+            pack->prefetch(CompressedTexture::cookedPath(path));
+        }
+        const TexturePack* source = pack;
+        ThreadPool* workers = pool;
+        MipGenerator::Filter filter = mipFilter;
+        Decode job;
+        job.stream = &target;
+        job.layer = layer;
+        job.image = pool->enqueue([source, workers, filter, path, channels, width, height] {
+            return decode(source, workers, filter, path, channels, width, height);
+        });
+        decodes.push_back(std::move(job));
+        ++target.decoding;
+    }
+
+    // Free the decoded images and let the packed files' pages go
+    void freeImages(Stream& target) {
+        for (std::shared_ptr<Image>& image : target.layers)
+            image.reset();
+        target.decodedLayers = 0;
+        if (!pack)
+            return;
+        for (const std::string& path : target.paths) {
+            pack->release(path);
+            pack->release(CompressedTexture::cookedPath(path));
+        }
+    }
+
+    // Worker side: decode (and for arrays resample), then build the mip chain with the other
+    // workers' help. A texture in the pack is read only from there, cooked or not; anything else from the disk.
+    static std::shared_ptr<Image> decode(const TexturePack* pack, ThreadPool* workers, MipGenerator::Filter filter, const std::string& path,
+                                         int channels, int width, int height) {
+        std::shared_ptr<Image> image = std::make_shared<Image>();
+        std::string cookedPath = CompressedTexture::cookedPath(path);
+        TexturePack::Blob packed = { nullptr, 0 }, packedCooked = { nullptr, 0 };
+        if (pack) {
+            packed = pack->find(path);
+            packedCooked = pack->find(cookedPath);
+        }
+        bool fromPack = packed.data || packedCooked.data;
+        if (!width && CompressedTexture::supported()) {
+            std::shared_ptr<CompressedTexture> cooked = std::make_shared<CompressedTexture>();
+            if (fromPack ? packedCooked.data && cooked->view(packedCooked.data, packedCooked.size) : cooked->open(cookedPath)) {
+                image->cooked = cooked;
+                for (const CompressedTexture::Level& level : cooked->levels()) {
+                    Level view = { (int)level.width, (int)level.height, level.data, level.size, (int)(level.height + 3) / 4 };
+                    image->levels.push_back(view);
+                }
+                return image;
+            }
+        }
+        stbi_set_flip_vertically_on_load_thread(true); // Same orientation as Texture
+        int imageWidth, imageHeight, imageChannels;
+        unsigned char* data;
+        if (fromPack)
+            data = packed.data ? stbi_load_from_memory(packed.data, (int)packed.size, &imageWidth, &imageHeight, &imageChannels, channels) : nullptr;
+        else
+            data = stbi_load(path.c_str(), &imageWidth, &imageHeight, &imageChannels, channels);
+        if (!data)
+            return image;
+        image->channels = channels ? channels : imageChannels;
+        std::vector<unsigned char> pixels;
+        if (width && (imageWidth != width || imageHeight != height)) {
+            pixels = TextureArray::resample(data, imageWidth, imageHeight, width, height);
+            imageWidth = width;
+            imageHeight = height;
+        }
+        else {
+            pixels.assign(data, data + (size_t)imageWidth * imageHeight * image->channels);
+        }
+        stbi_image_free(data);
+        image->pixels = MipGenerator::build(std::move(pixels), imageWidth, imageHeight, image->channels, filter, workers);
+        setLevels(*image, imageWidth, imageHeight);
+        return image;
+    }
+
+    static void setLevels(Image& image, int width, int height) {
+        image.levels.clear();
+        for (const std::vector<unsigned char>& pixels : image.pixels) {
+            Level view = { width, height, pixels.data(), pixels.size(), height };
+            image.levels.push_back(view);
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+    }
+
+    static std::shared_ptr<Image> greyImage(int width, int height) {
+        std::shared_ptr<Image> image = std::make_shared<Image>();
+        image->channels = 3;
+        for (int levelWidth = width, levelHeight = height;; levelWidth = std::max(1, levelWidth / 2), levelHeight = std::max(1, levelHeight / 2)) {
+            image->pixels.push_back(std::vector<unsigned char>((size_t)levelWidth * levelHeight * 3, 128));
+            if (levelWidth == 1 && levelHeight == 1)
+                break;
+        }
+        setLevels(*image, width, height);
+        return image;
+    }
+
+    static GLenum formatFor(int channels) {
+        return channels == 4 ? GL_RGBA : channels == 1 ? GL_RED : GL_RGB;
+    }
+
+    // Finest level that is still at least texels wide
+    static int levelFor(const Stream& target, float texels) {
+        float width = (float)target.shape[0].width;
+        int level = (int)std::floor(std::log2(std::max(1.0f, width / texels)));
+        return std::min(level, target.levelCount - 1);
+    }
+
+    GLenum bind(const Stream& target) const {
+        GLenum textureTarget = target.texture ? GL_TEXTURE_2D : GL_TEXTURE_2D_ARRAY;
+        glBindTexture(textureTarget, target.name);
+        return textureTarget;
+    }
+
+    // Create the texture object, sampling only the coarsest level (which has no storage yet)
+    void begin(Stream& target) {
+        const Image& first = *target.layers[0];
+        target.shape = first.levels;
+        for (Level& level : target.shape)
+            level.data = nullptr;
+        target.compressedFormat = first.cooked ? first.cooked->internalFormat() : 0;
+        target.channels = first.channels;
+        target.levelCount = (int)target.shape.size();
+        target.residentLevel = target.levelCount;
+        target.targetLevel = target.levelCount - 1;
+        target.previewLevel = 0;
+        while (target.previewLevel < target.levelCount - 1
+            && std::max(target.shape[target.previewLevel].width, target.shape[target.previewLevel].height) > PREVIEW_SIZE)
+            ++target.previewLevel;
+
+        glGenTextures(1, &target.name);
+        GLenum textureTarget = bind(target);
+        if (target.texture) {
+            target.texture->sampler.apply();
+        }
+        else {
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        glTexParameteri(textureTarget, GL_TEXTURE_MAX_LEVEL, target.levelCount - 1);
+        glTexParameteri(textureTarget, GL_TEXTURE_BASE_LEVEL, target.levelCount - 1);
+    }
+
+    // Storage of one level, every layer of an array; uncompressed RGB counts as RGBA, which
+    // is how drivers keep it
+    static size_t levelBytes(const Stream& target, int level) {
+        const Level& size = target.shape[level];
+        if (target.compressedFormat)
+            return size.size;
+        return (size_t)size.width * size.height * (target.channels == 3 ? 4 : target.channels) * target.layers.size();
+    }
+
+    // Storage for one level of the bound texture, every layer of an array at once; an empty
+    // level frees it
+    void define(Stream& target, int level, bool empty = false) {
+        const Level& size = target.shape[level];
+        int width = empty ? 0 : size.width, height = empty ? 0 : size.height;
+        if (target.compressedFormat)
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, target.compressedFormat, width, height, 0, empty ? 0 : (GLsizei)size.size, NULL);
+        else if (target.texture)
+            glTexImage2D(GL_TEXTURE_2D, level, formatFor(target.channels), width, height, 0, formatFor(target.channels), GL_UNSIGNED_BYTE, NULL);
+        else
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGB8, width, height, (GLsizei)target.layers.size(), 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+        size_t bytes = levelBytes(target, level);
+        if (empty) {
+            target.bytes -= bytes;
+            stats.residentBytes -= bytes;
+            return;
+        }
+        target.bytes += bytes;
+        stats.residentBytes += bytes;
+        stats.peakBytes = std::max(stats.peakBytes, stats.residentBytes);
+    }
+
+    // Free levels of textures not requested this frame, least recently requested first,
+    // until bytes more fit; false when only textures in use are left
+    bool makeRoom(size_t bytes, const Stream* keep) {
+        while (stats.residentBytes + bytes > stats.budget) {
+            Stream* victim = nullptr;
+            for (Stream& target : streams) {
+                if (&target == keep || !target.shown || target.lastUse == frame)
+                    continue;
+                bool reducible = target.residentLevel < target.previewLevel || (target.texture && target.lastUse + EVICT_FRAMES <= frame);
+                if (reducible && (!victim || target.lastUse < victim->lastUse))
+                    victim = &target;
+            }
+            if (!victim)
+                return false;
+            if (victim->residentLevel < victim->previewLevel)
+                dropLevel(*victim);
+            else
+                evict(*victim);
+        }
+        return true;
+    }
+
+    // Give up the finest resident level (and a partly uploaded finer one)
+    void dropLevel(Stream& target) {
+        GLenum textureTarget = bind(target);
+        if (target.levelDefined) {
+            define(target, target.residentLevel - 1, true);
+            target.levelDefined = false;
+            target.layer = 0;
+            target.uploadedRows = 0;
+        }
+        glTexParameteri(textureTarget, GL_TEXTURE_BASE_LEVEL, target.residentLevel + 1);
+        define(target, target.residentLevel, true);
+        ++target.residentLevel;
+        target.targetLevel = std::max(target.targetLevel, target.residentLevel);
+        ++stats.droppedLevels;
+    }
+
+    // Back to the placeholder until the texture is requested again
+    void evict(Stream& target) {
+        stats.residentBytes -= target.bytes;
+        target.bytes = 0;
+        target.texture->release();
+        target.name = 0;
+        target.shown = false;
+        target.evicted = true;
+        target.levelDefined = false;
+        target.layer = 0;
+        target.uploadedRows = 0;
+        freeImages(target);
+        ++stats.evictions;
+    }
+
+    // Copy rows through the stream buffer until goal is the base level, false when out of
+    // budget or stream space; the upload continues next frame where it stopped
+    bool uploadLevels(Stream& target, int goal, size_t& budget) {
+        while (target.residentLevel > goal) {
+            int level = target.residentLevel - 1;
+            if (!target.levelDefined) {
+                if (stats.budget && !makeRoom(levelBytes(target, level), &target) && target.shown) {
+                    // Stay at this level until the budget has room
+                    target.targetLevel = target.residentLevel;
+                    denied = true;
+                    return true;
+                }
+                bind(target);
+                define(target, level);
+                target.levelDefined = true;
+            }
+            for (; target.layer < target.layers.size(); ++target.layer, target.uploadedRows = 0) {
+                const Image& image = *target.layers[target.layer];
+                const Level& source = image.levels[level];
+                size_t rowBytes = source.size / source.rows;
+                int rowsPerChunk = (int)std::max<size_t>(1, CHUNK_BYTES / rowBytes);
+                while (target.uploadedRows < source.rows) {
+                    int rows = std::min(rowsPerChunk, source.rows - target.uploadedRows);
+                    size_t bytes = rows * rowBytes;
+                    // A chunk may exceed what is left of the budget only as the first one of the frame
+                    if (bytes > budget && budget < bytesPerFrame)
+                        return false;
+                    size_t offset;
+                    void* destination = stream->allocate(bytes, offset);
+                    if (!destination) {
+                        budget = 0;
+                        return false;
+                    }
+                    std::memcpy(destination, source.data + target.uploadedRows * rowBytes, bytes);
+                    stream->commit();
+                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stream->buffer());
+                    bind(target);
+                    if (image.cooked) {
+                        int y = target.uploadedRows * 4;
+                        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, y, source.width, std::min(rows * 4, source.height - y),
+                            image.cooked->internalFormat(), (GLsizei)bytes, (void*)offset);
+                    }
+                    else if (target.texture) {
+                        glTexSubImage2D(GL_TEXTURE_2D, level, 0, target.uploadedRows, source.width, rows, formatFor(image.channels), GL_UNSIGNED_BYTE, (void*)offset);
+                    }
+                    else {
+                        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, target.uploadedRows, (GLint)target.layer, source.width, rows, 1,
+                            GL_RGB, GL_UNSIGNED_BYTE, (void*)offset);
+                    }
+                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                    target.uploadedRows += rows;
+                    budget -= std::min(budget, bytes);
+                }
+            }
+            // The level is complete, let the sampler reach it
+            target.layer = 0;
+            target.levelDefined = false;
+            target.residentLevel = level;
+            glTexParameteri(bind(target), GL_TEXTURE_BASE_LEVEL, level);
+        }
+        return true;
+    }
+
+    // Swap the texture in for the placeholder
+    void show(Stream& target) {
+        if (target.texture) {
+            target.texture->ID = target.name;
+            target.texture->resident = true;
+        }
+        else {
+            glDeleteTextures(1, &target.array->ID);
+            unreserve((size_t)target.layers.size() * 4);
+            target.array->ID = target.name;
+            target.array->resident = true;
+        }
+        target.shown = true;
+        target.evicted = false;
+    }
+};
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef TEXTUREPACK_H
+#define TEXTUREPACK_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+#include "MappedFile.h"
+
+// Many texture files in one file, mapped once at startup:
+//
+//   Header | Entry[entryCount] | names | payloads (each aligned to PAGE_ALIGNMENT)
+//
+// Written by tools/texpack. A payload is the packed file unchanged (a source image or
+// a cooked .gktx) and starts on its own page, so paging hints for one texture never
+// touch another. Only the header and table are checksummed on open, the payloads are
+// checked by their decoders; reading them is plain memory access into the mapping.
+class TexturePack {
+public:
+    static const uint32_t VERSION = 1;
+    static const size_t PAGE_ALIGNMENT = 4096;
+
+    // One packed file, data is null when the pack does not have it
+    struct Blob {
+        const unsigned char* data;
+        size_t size;
+    };
+
+    // Map and validate a pack, false when missing or corrupt
+    bool open(const std::string& path) {
+        index.clear();
+        directory = workingDirectory();
+        if (!file.open(path) || !validate()) {
+            file.close();
+            index.clear();
+            return false;
+        }
+        // Textures are read in no particular order; the table is needed right away
+        file.advise(0, file.size(), MappedFile::RANDOM);
+        file.advise(0, tableEnd, MappedFile::WILL_NEED);
+        return true;
+    }
+
+    bool isOpen() const {
+        return file.isOpen();
+    }
+
+    size_t size() const {
+        return index.size();
+    }
+
+    // Look up a path as the program spells it ("textures/earth.bmp", ".\\textures\\earth.bmp"
+    // or absolute below the working directory); safe from any thread
+    Blob find(const std::string& path) const {
+        Blob blob = { nullptr, 0 };
+        std::unordered_map<std::string, size_t>::const_iterator it = index.find(name(path, directory));
+        if (it != index.end()) {
+            blob.data = file.data() + entries[it->second].offset;
+            blob.size = (size_t)entries[it->second].size;
+        }
+        return blob;
+    }
+
+    // Start paging a texture in before a worker decodes it
+    void prefetch(const std::string& path) const {
+        advise(path, MappedFile::WILL_NEED);
+    }
+
+    // The texture is uploaded, its pages may leave memory (they are read again if touched)
+    void release(const std::string& path) const {
+        advise(path, MappedFile::DONT_NEED);
+    }
+
+    // Key of a path in the pack: forward slashes, relative to the working directory
+    static std::string name(const std::string& path) {
+        return name(path, workingDirectory());
+    }
+
+    static std::string name(const std::string& path, const std::string& directory) {
+        std::string result = path;
+        for (char& c : result)
+            if (c == '\\')
+                c = '/';
+        if (!directory.empty() && result.size() > directory.size() && result.compare(0, directory.size(), directory) == 0 && result[directory.size()] == '/')
+            result.erase(0, directory.size() + 1);
+        while (result.compare(0, 2, "./") == 0)
+            result.erase(0, 2);
+        return result;
+    }
+
+    // Write the files at sources under the given names, replacing any older pack atomically
+    static bool store(const std::string& path, const std::vector<std::string>& names, const std::vector<std::string>& sources) {
+        std::vector<Entry> table(names.size());
+        std::string nameTable;
+        for (size_t i = 0; i < names.size(); ++i) {
+            std::ifstream source(sources[i], std::ios::binary | std::ios::ate);
+            if (!source)
+                return false;
+            table[i].size = (uint64_t)source.tellg();
+            table[i].nameOffset = (uint32_t)nameTable.size();
+            table[i].nameLength = (uint32_t)names[i].size();
+            nameTable += names[i];
+        }
+        uint64_t offset = align(sizeof(Header) + table.size() * sizeof(Entry) + nameTable.size());
+        for (Entry& entry : table) {
+            entry.offset = offset;
+            offset = align(offset + entry.size);
+        }
+        Header header = {};
+        memcpy(header.magic, magic(), 4);
+        header.version = VERSION;
+        header.entryCount = (uint32_t)table.size();
+        header.nameBytes = (uint32_t)nameTable.size();
+        header.fileSize = offset;
+        header.tableChecksum = checksum(table.data(), table.size() * sizeof(Entry)) ^ checksum(nameTable.data(), nameTable.size());
+
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            out.write((const char*)&header, sizeof(header));
+            out.write((const char*)table.data(), (std::streamsize)(table.size() * sizeof(Entry)));
+            out.write(nameTable.data(), (std::streamsize)nameTable.size());
+            uint64_t written = sizeof(header) + table.size() * sizeof(Entry) + nameTable.size();
+            std::vector<char> buffer(1 << 20);
+            static const char padding[PAGE_ALIGNMENT] = {};
+            for (size_t i = 0; i < table.size(); ++i) {
+                out.write(padding, (std::streamsize)(table[i].offset - written));
+                std::ifstream source(sources[i], std::ios::binary);
+                for (uint64_t remaining = table[i].size; remaining > 0;) {
+                    std::streamsize chunk = (std::streamsize)std::min<uint64_t>(remaining, buffer.size());
+                    if (!source.read(buffer.data(), chunk))
+                        return false;
+                    out.write(buffer.data(), chunk);
+                    remaining -= (uint64_t)chunk;
+                }
+                written = table[i].offset + table[i].size;
+            }
+            out.write(padding, (std::streamsize)(offset - written));
+            if (!out)
+                return false;
+        }
+        std::remove(path.c_str());
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t nameBytes;
+        uint64_t fileSize;
+        uint64_t tableChecksum;
+    };
+
+    struct Entry {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+
+    MappedFile file;
+    const Entry* entries = nullptr;
+    size_t tableEnd = 0;
+    std::string directory; // working directory at open(), for absolute paths
+    std::unordered_map<std::string, size_t> index; // name -> entry
+
+    static const char* magic() {
+        return "GKPK";
+    }
+
+    static uint64_t align(uint64_t value) {
+        return (value + PAGE_ALIGNMENT - 1) & ~(uint64_t)(PAGE_ALIGNMENT - 1);
+    }
+
+    // FNV-1a over 64-bit words, bytewise for the tail (same as MeshCache)
+    static uint64_t checksum(const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        uint64_t hash = 0xCBF29CE484222325ull;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            hash = (hash ^ word) * 0x100000001B3ull;
+        }
+        for (; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        return hash ^ size;
+    }
+
+    static std::string workingDirectory() {
+        char buffer[4096];
+#ifdef _WIN32
+        if (!_getcwd(buffer, sizeof(buffer)))
+            return std::string();
+#else
+        if (!getcwd(buffer, sizeof(buffer)))
+            return std::string();
+#endif
+        std::string result = buffer;
+        for (char& c : result)
+            if (c == '\\')
+                c = '/';
+        return result;
+    }
+
+    void advise(const std::string& path, MappedFile::Advice advice) const {
+        Blob blob = find(path);
+        if (blob.data)
+            file.advise((size_t)(blob.data - file.data()), blob.size, advice);
+    }
+
+    bool validate() {
+        if (file.size() < sizeof(Header))
+            return false;
+        Header header;
+        memcpy(&header, file.data(), sizeof(header));
+        tableEnd = sizeof(Header) + (size_t)header.entryCount * sizeof(Entry) + header.nameBytes;
+        if (memcmp(header.magic, magic(), 4) != 0 || header.version != VERSION || header.fileSize != file.size() || tableEnd > file.size())
+            return false;
+        entries = (const Entry*)(file.data() + sizeof(Header));
+        const char* names = (const char*)(entries + header.entryCount);
+        if ((checksum(entries, header.entryCount * sizeof(Entry)) ^ checksum(names, header.nameBytes)) != header.tableChecksum)
+            return false;
+        for (uint32_t i = 0; i < header.entryCount; ++i) {
+            const Entry& entry = entries[i];
+            if (entry.offset % PAGE_ALIGNMENT != 0 || entry.offset < tableEnd
+                || entry.offset > file.size() || entry.size > file.size() - entry.offset // offset + size could wrap
+                || (uint64_t)entry.nameOffset + entry.nameLength > header.nameBytes)
+                return false;
+            index[std::string(names + entry.nameOffset, entry.nameLength)] = i;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+
+// Simple fixed-size pool of worker threads
+class ThreadPool {
+public:
+    // Constructor starting the workers (0 = one per hardware thread)
+    explicit ThreadPool(unsigned int threadCount = 0) : stopping(false) {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 0; i < threadCount; ++i)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int size() const {
+        return (unsigned int)workers.size();
+    }
+
+    // Queue a job, the returned future becomes ready when it has run
+    template <class F>
+    std::future<typename std::result_of<F()>::type> enqueue(F&& job) {
+        typedef typename std::result_of<F()>::type Result;
+        std::shared_ptr<std::packaged_task<Result()>> task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back([task] { (*task)(); });
+        }
+        wake.notify_one();
+        return result;
+    }
+
+    // Split [0, count) into one range per worker and block until all ranges are done.
+    // The calling thread takes the first range; a worker calling this runs queued jobs while
+    // it waits, so ranges stuck behind jobs that wait the same way still get a thread.
+    void parallelFor(size_t count, const std::function<void(size_t begin, size_t end, unsigned int part)>& body) {
+        if (count == 0)
+            return;
+        unsigned int parts = (unsigned int)std::min<size_t>(count, size() + 1);
+        size_t step = (count + parts - 1) / parts;
+        std::vector<std::future<void>> pending;
+        for (unsigned int part = 1; part < parts; ++part) {
+            size_t begin = part * step;
+            size_t end = std::min(count, begin + step);
+            if (begin >= end)
+                break;
+            pending.push_back(enqueue([&body, begin, end, part] { body(begin, end, part); }));
+        }
+        body(0, std::min(count, step), 0);
+        bool worker = current() == this;
+        for (std::future<void>& f : pending) {
+            while (worker && f.wait_for(std::chrono::seconds(0)) != std::future_status::ready && runQueued()) {
+            }
+            f.get();
+        }
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    // Pool whose worker runs on this thread, null elsewhere (e.g. on the GL thread, which must not pick up decodes)
+    static ThreadPool*& current() {
+        static thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    // Run one queued job on the calling thread, false when there is none
+    bool runQueued() {
+        std::function<void()> job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (jobs.empty())
+                return false;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+        return true;
+    }
+
+    void workerLoop() {
+        current() = this;
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty())
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+#endif
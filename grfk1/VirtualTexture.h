@@ -0,0 +1,647 @@
+#ifndef VIRTUALTEXTURE_H
+#define VIRTUALTEXTURE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include "MappedFile.h"
+#include "StreamBuffer.h"
+#include "ThreadPool.h"
+#include "Shader.h"
+
+// Mip-tiled page file written by tools/vttile:
+//
+//   Header | Level[levelCount] | tiles (each padded to TILE_ALIGNMENT)
+//
+// Level 0 is width x height texels, both TILE_SIZE times a power of two, and every
+// level halves it down to a single tile. A tile is TILE_SIZE^2 RGB texels plus a
+// BORDER copied from its neighbours (wrapping in u, clamped in v) so bilinear
+// filtering in the physical cache never reads another tile. Tiles are stored by
+// level, then row (bottom first, like the flipped stb_image output), then column.
+class VirtualTextureFile {
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t TILE_SIZE = 128;
+    static const uint32_t BORDER = 4;
+    static const uint32_t SLOT_SIZE = TILE_SIZE + 2 * BORDER;
+    static const size_t TILE_BYTES = (size_t)SLOT_SIZE * SLOT_SIZE * 3;
+    static const size_t TILE_ALIGNMENT = 4096;
+    static const size_t TILE_STRIDE = (TILE_BYTES + TILE_ALIGNMENT - 1) / TILE_ALIGNMENT * TILE_ALIGNMENT;
+
+    struct Level {
+        uint32_t tilesX;
+        uint32_t tilesY;
+        uint64_t firstTile;
+    };
+
+    // Tile grid of every level for a level 0 of width x height texels
+    static std::vector<Level> layout(uint32_t width, uint32_t height) {
+        std::vector<Level> levels;
+        uint32_t tilesX = width / TILE_SIZE, tilesY = height / TILE_SIZE;
+        uint64_t first = 0;
+        for (;;) {
+            Level level = { tilesX, tilesY, first };
+            levels.push_back(level);
+            first += (uint64_t)tilesX * tilesY;
+            if (tilesX == 1 && tilesY == 1)
+                return levels;
+            tilesX = std::max(1u, tilesX / 2);
+            tilesY = std::max(1u, tilesY / 2);
+        }
+    }
+
+    static bool validSize(uint32_t width, uint32_t height) {
+        uint32_t tilesX = width / TILE_SIZE, tilesY = height / TILE_SIZE;
+        return tilesX && tilesY && width == tilesX * TILE_SIZE && height == tilesY * TILE_SIZE
+            && (tilesX & (tilesX - 1)) == 0 && (tilesY & (tilesY - 1)) == 0;
+    }
+
+    // Header and level table; the tiles follow in layout() order, each TILE_STRIDE bytes
+    static std::vector<unsigned char> header(uint32_t width, uint32_t height) {
+        std::vector<Level> levels = layout(width, height);
+        Header header = {};
+        memcpy(header.magic, magic(), 4);
+        header.version = VERSION;
+        header.tileSize = TILE_SIZE;
+        header.border = BORDER;
+        header.width = width;
+        header.height = height;
+        header.levelCount = (uint32_t)levels.size();
+        header.tileCount = levels.back().firstTile + 1;
+        header.dataOffset = dataOffset(levels.size());
+        header.tableChecksum = checksum(levels.data(), levels.size() * sizeof(Level));
+        std::vector<unsigned char> bytes((size_t)header.dataOffset, 0);
+        memcpy(bytes.data(), &header, sizeof(header));
+        memcpy(bytes.data() + sizeof(header), levels.data(), levels.size() * sizeof(Level));
+        return bytes;
+    }
+
+    // Map and validate a page file, false when missing or corrupt
+    bool open(const std::string& path) {
+        levelTable.clear();
+        if (!file.open(path) || !validate()) {
+            file.close();
+            levelTable.clear();
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t width() const { return textureWidth; }
+    uint32_t height() const { return textureHeight; }
+    const std::vector<Level>& levels() const { return levelTable; }
+
+    // TILE_BYTES of RGB texels, rows of SLOT_SIZE; reading them may fault pages in from disk
+    const unsigned char* tile(unsigned int level, unsigned int x, unsigned int y) const {
+        const Level& entry = levelTable[level];
+        return file.data() + tilesOffset + (entry.firstTile + (uint64_t)y * entry.tilesX + x) * TILE_STRIDE;
+    }
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t tileSize;
+        uint32_t border;
+        uint32_t width;
+        uint32_t height;
+        uint32_t levelCount;
+        uint32_t reserved;
+        uint64_t tileCount;
+        uint64_t dataOffset;
+        uint64_t tableChecksum;
+    };
+
+    MappedFile file;
+    uint32_t textureWidth = 0;
+    uint32_t textureHeight = 0;
+    uint64_t tilesOffset = 0;
+    std::vector<Level> levelTable;
+
+    static const char* magic() {
+        return "GKVT";
+    }
+
+    static uint64_t dataOffset(size_t levelCount) {
+        uint64_t tableEnd = sizeof(Header) + levelCount * sizeof(Level);
+        return (tableEnd + TILE_ALIGNMENT - 1) / TILE_ALIGNMENT * TILE_ALIGNMENT;
+    }
+
+    // FNV-1a over 64-bit words, bytewise for the tail (same as MeshCache)
+    static uint64_t checksum(const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        uint64_t hash = 0xCBF29CE484222325ull;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            hash = (hash ^ word) * 0x100000001B3ull;
+        }
+        for (; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        return hash ^ size;
+    }
+
+    // Only the header and table are checked, the tiles are far too large to hash on open
+    bool validate() {
+        if (file.size() < sizeof(Header))
+            return false;
+        Header header;
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, magic(), 4) != 0 || header.version != VERSION || header.tileSize != TILE_SIZE
+            || header.border != BORDER || !validSize(header.width, header.height) || header.levelCount == 0 || header.levelCount > 32
+            || header.dataOffset != dataOffset(header.levelCount) || header.dataOffset + header.tileCount * TILE_STRIDE != file.size())
+            return false;
+        std::vector<Level> expected = layout(header.width, header.height);
+        const unsigned char* table = file.data() + sizeof(Header);
+        if (expected.size() != header.levelCount || checksum(table, expected.size() * sizeof(Level)) != header.tableChecksum
+            || memcmp(table, expected.data(), expected.size() * sizeof(Level)) != 0 || expected.back().firstTile + 1 != header.tileCount)
+            return false;
+        textureWidth = header.width;
+        textureHeight = header.height;
+        tilesOffset = header.dataOffset;
+        levelTable = expected;
+        return true;
+    }
+};
+
+struct VirtualTextureStats {
+    unsigned int requested = 0; // distinct tiles in the last feedback, with their parents
+    unsigned int resident = 0;
+    unsigned int reading = 0;   // tiles being read by the workers
+    unsigned int uploads = 0;
+    unsigned int evictions = 0;
+    unsigned int dropped = 0;   // read but no longer wanted, or no slot free this frame
+};
+
+// Texture far larger than video memory, sampled through a page table. The shader
+// (fragment_shader.glsl, sampleVirtual) picks a mip level from the texel derivatives,
+// reads the page table texel of that level and samples the physical cache, a fixed
+// grid of CACHE_SLOTS^2 tile slots. Tiles the feedback pass asks for are read from the
+// mapped page file by the thread pool and uploaded through the stream buffer, at most
+// tilesPerFrame per update(); least recently used slots are reused. A page table entry
+// without its own tile points at the nearest resident ancestor, and the single tile of
+// the coarsest level is always resident, so the texture is never missing.
+class VirtualTexture {
+public:
+    static const unsigned int CACHE_SLOTS = 16;
+    static const unsigned int CACHE_SIZE = CACHE_SLOTS * VirtualTextureFile::SLOT_SIZE;
+    static const size_t MAX_READS = 64;
+    static const uint64_t STALE_FRAMES = 30; // a read tile is dropped when not requested for this long
+
+    // The page table is bound to texture unit firstUnit and the cache to firstUnit + 1
+    VirtualTexture(ThreadPool& pool, StreamBuffer& stream, unsigned int firstUnit, unsigned int tilesPerFrame = 8)
+        : pool(&pool), stream(&stream), unit(firstUnit), tilesPerFrame(tilesPerFrame), pageTableDirty(false), frame(0) {
+        // 1x1 textures keep the samplers complete until open()
+        glGenTextures(1, &pageTableID);
+        glGenTextures(1, &cacheID);
+        uint32_t entry = 0;
+        bindPageTable();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, 1, 1, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &entry);
+        unsigned char grey[4] = { 128, 128, 128, 255 };
+        bindCache();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    // Map a page file, allocate the page table and cache and make the coarsest tile resident
+    bool open(const std::string& path) {
+        std::shared_ptr<VirtualTextureFile> source = std::make_shared<VirtualTextureFile>();
+        if (!source->open(path)) {
+            std::cerr << "ERROR::VIRTUALTEXTURE::PAGE_FILE_NOT_LOADED " << path << std::endl;
+            return false;
+        }
+        file = source;
+        const std::vector<VirtualTextureFile::Level>& levels = file->levels();
+
+        bindPageTable();
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+        pageTable.resize(levels.size());
+        for (size_t level = 0; level < levels.size(); ++level) {
+            pageTable[level].assign((size_t)levels[level].tilesX * levels[level].tilesY, 0);
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_R32UI, levels[level].tilesX, levels[level].tilesY, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+        }
+        bindCache();
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, CACHE_SIZE, CACHE_SIZE, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+
+        slots.assign(CACHE_SLOTS * CACHE_SLOTS, Slot());
+        residentSlots.clear();
+        unsigned int top = (unsigned int)levels.size() - 1;
+        slots[0].key = key(top, 0, 0);
+        slots[0].pinned = true;
+        residentSlots[slots[0].key] = 0;
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, VirtualTextureFile::SLOT_SIZE, VirtualTextureFile::SLOT_SIZE, GL_RGB, GL_UNSIGNED_BYTE, file->tile(top, 0, 0));
+        glActiveTexture(GL_TEXTURE0);
+        pageTableDirty = true;
+        updatePageTable();
+        return true;
+    }
+
+    bool valid() const {
+        return file != nullptr;
+    }
+
+    unsigned int width() const { return file ? file->width() : 0; }
+    unsigned int height() const { return file ? file->height() : 0; }
+    unsigned int levelCount() const { return file ? (unsigned int)file->levels().size() : 0; }
+
+    // Fixed GL storage of the page table and the cache (RGB8 counted as 4 bytes, as drivers pad it),
+    // for TextureLoader::reserve; the 1x1 stand-ins until open()
+    size_t storageBytes() const {
+        if (!file)
+            return 2 * 4;
+        size_t bytes = (size_t)CACHE_SIZE * CACHE_SIZE * 4;
+        for (const VirtualTextureFile::Level& level : file->levels())
+            bytes += (size_t)level.tilesX * level.tilesY * sizeof(uint32_t);
+        return bytes;
+    }
+
+    // Samplers and sizes for sampleVirtual in the scene shaders, index 0 or 1; the program must be in use
+    void bind(Shader& shader, int index) const {
+        std::string suffix = std::to_string(index);
+        shader.setInt("virtualPageTable" + suffix, (int)unit);
+        shader.setInt("virtualCache" + suffix, (int)unit + 1);
+        shader.setVec4("virtualInfo" + suffix, info());
+        shader.setVec3("virtualLayout" + suffix, glm::vec3((float)VirtualTextureFile::BORDER, (float)VirtualTextureFile::SLOT_SIZE, (float)CACHE_SIZE));
+    }
+
+    // Uniforms of feedback_fragment_shader.glsl for drawing a body using this texture
+    void bindFeedback(Shader& shader, int index) const {
+        shader.setInt("virtualIndex", index);
+        shader.setVec4("virtualInfo", info());
+    }
+
+    // A tile seen by the feedback pass; its ancestors are wanted as well, so
+    // every level on the way down to it gets streamed in
+    void request(unsigned int level, unsigned int x, unsigned int y) {
+        if (!file || level >= file->levels().size())
+            return;
+        const std::vector<VirtualTextureFile::Level>& levels = file->levels();
+        if (x >= levels[level].tilesX || y >= levels[level].tilesY)
+            return;
+        for (; level < levels.size(); ++level, x /= 2, y /= 2)
+            if (!requested.insert(key(level, x, y)).second)
+                return;
+    }
+
+    // Once per frame on the GL thread, after the feedback of the frame was collected
+    void update() {
+        if (!file)
+            return;
+        ++frame;
+
+        // Resident tiles stay in use, missing ones are read coarsest first
+        std::vector<uint64_t> missing;
+        for (uint64_t wantedKey : requested) {
+            std::unordered_map<uint64_t, unsigned int>::iterator resident = residentSlots.find(wantedKey);
+            if (resident != residentSlots.end()) {
+                slots[resident->second].lastUsed = frame;
+                continue;
+            }
+            wanted[wantedKey] = frame;
+            if (!reading.count(wantedKey))
+                missing.push_back(wantedKey);
+        }
+        if (!requested.empty())
+            stats.requested = (unsigned int)requested.size();
+        requested.clear();
+        std::sort(missing.begin(), missing.end(), [](uint64_t a, uint64_t b) { return a > b; });
+        for (size_t i = 0; i < missing.size() && reads.size() < MAX_READS; ++i)
+            startRead(missing[i]);
+
+        // Finished reads into free or least recently used slots, within the budget
+        unsigned int budget = tilesPerFrame;
+        for (std::list<Read>::iterator it = reads.begin(); it != reads.end() && budget > 0;) {
+            if (it->data.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+            std::unordered_map<uint64_t, uint64_t>::iterator wantedAt = wanted.find(it->key);
+            int slot = -1;
+            if (wantedAt != wanted.end() && frame - wantedAt->second <= STALE_FRAMES)
+                slot = allocateSlot();
+            if (slot < 0) {
+                it->data.get();
+                ++stats.dropped;
+            }
+            else if (!upload(*it, slot)) {
+                break; // stream buffer full, the tile waits for the next frame
+            }
+            else {
+                --budget;
+            }
+            if (wantedAt != wanted.end())
+                wanted.erase(wantedAt);
+            reading.erase(it->key);
+            it = reads.erase(it);
+        }
+
+        // Forget requests that were never read because the queue was full
+        if (wanted.size() > 4 * MAX_READS) {
+            for (std::unordered_map<uint64_t, uint64_t>::iterator it = wanted.begin(); it != wanted.end();)
+                it = !reading.count(it->first) && frame - it->second > STALE_FRAMES ? wanted.erase(it) : std::next(it);
+        }
+
+        updatePageTable();
+        stats.resident = (unsigned int)residentSlots.size();
+        stats.reading = (unsigned int)reads.size();
+    }
+
+    const VirtualTextureStats& statistics() const {
+        return stats;
+    }
+
+    // Waits for reads that are still running
+    void destroy() {
+        for (Read& read : reads)
+            read.data.wait();
+        reads.clear();
+        reading.clear();
+        glDeleteTextures(1, &pageTableID);
+        glDeleteTextures(1, &cacheID);
+        file.reset();
+    }
+
+private:
+    struct Slot {
+        uint64_t key = EMPTY;
+        uint64_t lastUsed = 0;
+        bool pinned = false;
+    };
+
+    struct Read {
+        uint64_t key;
+        std::future<std::vector<unsigned char>> data;
+    };
+
+    static const uint64_t EMPTY = ~0ull;
+    static const uint32_t OWN_TILE = 1u << 31; // page table entry of a resident tile, not inherited
+
+    ThreadPool* pool;
+    StreamBuffer* stream;
+    unsigned int unit;
+    unsigned int tilesPerFrame;
+    std::shared_ptr<VirtualTextureFile> file; // shared with the reads in flight
+    unsigned int pageTableID, cacheID;
+    std::vector<std::vector<uint32_t>> pageTable; // CPU copy, one grid per level
+    bool pageTableDirty;
+    std::vector<Slot> slots;
+    std::unordered_map<uint64_t, unsigned int> residentSlots; // tile key -> slot
+    std::unordered_set<uint64_t> requested;             // since the last update()
+    std::unordered_map<uint64_t, uint64_t> wanted;      // missing tile key -> frame it was last requested
+    std::unordered_set<uint64_t> reading;
+    std::list<Read> reads;
+    uint64_t frame;
+    VirtualTextureStats stats;
+
+    // Level in the high bits, so sorting keys descending puts coarse tiles first
+    static uint64_t key(unsigned int level, unsigned int x, unsigned int y) {
+        return (uint64_t)level << 48 | (uint64_t)y << 24 | x;
+    }
+
+    // Page table texel: cache slot column and row, level of the tile in that slot (the shader ignores OWN_TILE)
+    static uint32_t entry(unsigned int slot, unsigned int level) {
+        return (slot % CACHE_SLOTS) | (slot / CACHE_SLOTS) << 8 | level << 16;
+    }
+
+    glm::vec4 info() const {
+        return glm::vec4((float)width(), (float)height(), (float)levelCount(), (float)VirtualTextureFile::TILE_SIZE);
+    }
+
+    void bindPageTable() const {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, pageTableID);
+    }
+
+    void bindCache() const {
+        glActiveTexture(GL_TEXTURE0 + unit + 1);
+        glBindTexture(GL_TEXTURE_2D, cacheID);
+    }
+
+    void startRead(uint64_t tileKey) {
+        unsigned int level = (unsigned int)(tileKey >> 48);
+        unsigned int y = (unsigned int)(tileKey >> 24) & 0xFFFFFF;
+        unsigned int x = (unsigned int)tileKey & 0xFFFFFF;
+        std::shared_ptr<VirtualTextureFile> source = file;
+        Read read;
+        read.key = tileKey;
+        read.data = pool->enqueue([source, level, x, y] {
+            const unsigned char* tile = source->tile(level, x, y);
+            return std::vector<unsigned char>(tile, tile + VirtualTextureFile::TILE_BYTES);
+        });
+        reads.push_back(std::move(read));
+        reading.insert(tileKey);
+    }
+
+    // A free slot, otherwise the least recently used one not needed this frame; -1 when none
+    int allocateSlot() {
+        int best = -1;
+        for (size_t slot = 0; slot < slots.size(); ++slot) {
+            if (slots[slot].key == EMPTY)
+                return (int)slot;
+            if (!slots[slot].pinned && slots[slot].lastUsed < frame && (best < 0 || slots[slot].lastUsed < slots[best].lastUsed))
+                best = (int)slot;
+        }
+        if (best >= 0) {
+            residentSlots.erase(slots[best].key);
+            slots[best].key = EMPTY;
+            ++stats.evictions;
+            pageTableDirty = true;
+        }
+        return best;
+    }
+
+    // Copy a finished read into its slot through the stream buffer, false when the stream is full
+    bool upload(Read& read, int slot) {
+        size_t offset;
+        void* destination = stream->allocate(VirtualTextureFile::TILE_BYTES, offset);
+        if (!destination) {
+            slots[slot].lastUsed = 0;
+            return false;
+        }
+        std::vector<unsigned char> data = read.data.get();
+        std::memcpy(destination, data.data(), data.size());
+        stream->commit();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stream->buffer());
+        bindCache();
+        glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % CACHE_SLOTS) * VirtualTextureFile::SLOT_SIZE, (slot / CACHE_SLOTS) * VirtualTextureFile::SLOT_SIZE,
+            VirtualTextureFile::SLOT_SIZE, VirtualTextureFile::SLOT_SIZE, GL_RGB, GL_UNSIGNED_BYTE, (void*)offset);
+        glActiveTexture(GL_TEXTURE0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        slots[slot].key = read.key;
+        slots[slot].lastUsed = frame;
+        residentSlots[read.key] = (unsigned int)slot;
+        ++stats.uploads;
+        pageTableDirty = true;
+        return true;
+    }
+
+    // Rebuild from the coarsest level down, missing tiles inherit their parent's entry
+    void updatePageTable() {
+        if (!pageTableDirty)
+            return;
+        pageTableDirty = false;
+        const std::vector<VirtualTextureFile::Level>& levels = file->levels();
+        for (std::vector<uint32_t>& entries : pageTable)
+            std::fill(entries.begin(), entries.end(), 0u);
+        for (size_t slot = 0; slot < slots.size(); ++slot) {
+            if (slots[slot].key == EMPTY)
+                continue;
+            unsigned int level = (unsigned int)(slots[slot].key >> 48);
+            unsigned int y = (unsigned int)(slots[slot].key >> 24) & 0xFFFFFF;
+            unsigned int x = (unsigned int)slots[slot].key & 0xFFFFFF;
+            pageTable[level][(size_t)y * levels[level].tilesX + x] = entry((unsigned int)slot, level) | OWN_TILE;
+        }
+        bindPageTable();
+        for (size_t level = levels.size(); level-- > 0;) {
+            const VirtualTextureFile::Level& grid = levels[level];
+            std::vector<uint32_t>& entries = pageTable[level];
+            if (level + 1 < levels.size()) {
+                const std::vector<uint32_t>& parents = pageTable[level + 1];
+                for (unsigned int y = 0; y < grid.tilesY; ++y)
+                    for (unsigned int x = 0; x < grid.tilesX; ++x)
+                        if (!(entries[(size_t)y * grid.tilesX + x] & OWN_TILE))
+                            entries[(size_t)y * grid.tilesX + x] = parents[(size_t)(y / 2) * levels[level + 1].tilesX + x / 2] & ~OWN_TILE;
+            }
+            glTexSubImage2D(GL_TEXTURE_2D, (GLint)level, 0, 0, grid.tilesX, grid.tilesY, GL_RED_INTEGER, GL_UNSIGNED_INT, entries.data());
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+};
+
+// Low resolution pass that writes, for every pixel of a virtually textured body, the
+// tile it would sample (feedback_fragment_shader.glsl). The result is read back through
+// a pixel pack buffer and decoded a frame later, so the GPU is never waited on.
+class VirtualTextureFeedback {
+public:
+    static const unsigned int SCALE = 8; // feedback pixel = SCALE x SCALE screen pixels
+
+    VirtualTextureFeedback(unsigned int screenWidth, unsigned int screenHeight)
+        : width(std::max(1u, screenWidth / SCALE)), height(std::max(1u, screenHeight / SCALE)), next(0) {
+        glGenFramebuffers(1, &FBO);
+        glGenTextures(1, &colorID);
+        glGenRenderbuffers(1, &depthID);
+        glBindTexture(GL_TEXTURE_2D, colorID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthID);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorID, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthID);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "ERROR::VIRTUALTEXTURE::FEEDBACK_FRAMEBUFFER_INCOMPLETE" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenBuffers(2, PBOs);
+        for (int i = 0; i < 2; ++i) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, PBOs[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)width * height * sizeof(uint32_t), NULL, GL_STREAM_READ);
+            fences[i] = 0;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    VirtualTextureFeedback(const VirtualTextureFeedback&) = delete;
+    VirtualTextureFeedback& operator=(const VirtualTextureFeedback&) = delete;
+
+    void destroy() {
+        for (int i = 0; i < 2; ++i)
+            if (fences[i])
+                glDeleteSync(fences[i]);
+        glDeleteBuffers(2, PBOs);
+        glDeleteFramebuffers(1, &FBO);
+        glDeleteTextures(1, &colorID);
+        glDeleteRenderbuffers(1, &depthID);
+    }
+
+    // Decode the newest finished readback into textures[index]->request(); call before their update()
+    void collect(VirtualTexture* const* textures, unsigned int count) {
+        unsigned int newest = next ^ 1;
+        if (!fences[newest])
+            return;
+        GLenum status = glClientWaitSync(fences[newest], 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            return;
+        glDeleteSync(fences[newest]);
+        fences[newest] = 0;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, PBOs[newest]);
+        const uint32_t* pixels = (const uint32_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (size_t)width * height * sizeof(uint32_t), GL_MAP_READ_BIT);
+        if (pixels) {
+            // Neighbouring pixels mostly need the same tile
+            uint32_t previous = 0;
+            for (size_t i = 0; i < (size_t)width * height; ++i) {
+                uint32_t value = pixels[i];
+                if (!(value & VALID) || value == previous)
+                    continue;
+                previous = value;
+                unsigned int index = (value >> 29) & 3;
+                if (index < count)
+                    textures[index]->request((value >> 24) & 0x1F, value & 0xFFF, (value >> 12) & 0xFFF);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    // Render into the feedback target with shader, whose level selection is shifted for the smaller target
+    void begin(Shader& shader) {
+        glGetIntegerv(GL_VIEWPORT, savedViewport);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glViewport(0, 0, width, height);
+        const GLuint none[4] = { 0, 0, 0, 0 };
+        glClearBufferuiv(GL_COLOR, 0, none);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        shader.use();
+        shader.setFloat("lodOffset", -std::log2((float)SCALE));
+    }
+
+    // Start the asynchronous readback and return to the default framebuffer
+    void end() {
+        if (fences[next])
+            glDeleteSync(fences[next]);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, PBOs[next]);
+        glReadPixels(0, 0, width, height, GL_RED_INTEGER, GL_UNSIGNED_INT, (void*)0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        fences[next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        next ^= 1;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+    }
+
+private:
+    static const uint32_t VALID = 1u << 31;
+
+    unsigned int width, height;
+    unsigned int FBO, colorID, depthID;
+    unsigned int PBOs[2];
+    GLsync fences[2];
+    unsigned int next; // PBO the next end() reads into
+    GLint savedViewport[4];
+};
+
+#endif
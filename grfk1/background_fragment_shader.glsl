@@ -1,11 +1,11 @@
-#version 330 core
-out vec4 FragColor;
-
-in vec2 TexCoords;
-
-uniform sampler2D backgroundTexture;
-
-void main()
-{
-    FragColor = texture(backgroundTexture, TexCoords);
+#version 330 core
+out vec4 FragColor;
+
+in vec3 Direction;
+
+uniform samplerCube backgroundTexture;
+
+void main()
+{
+    FragColor = vec4(texture(backgroundTexture, Direction).rgb, 1.0);
 }
\ No newline at end of file
@@ -1,11 +1,16 @@
-#version 330 core
-layout (location = 0) in vec2 aPos;
-layout (location = 1) in vec2 aTexCoords;
-
-out vec2 TexCoords;
-
-void main()
-{
-    TexCoords = aTexCoords;
-    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
-}
+#version 330 core
+out vec3 Direction;
+
+// Odwrotnosc projection * view bez przesuniecia kamery (Skybox::inverseViewProjection)
+uniform mat4 inverseViewProjection;
+
+void main()
+{
+    // Jeden trojkat przykrywajacy ekran: (-1, -1), (3, -1), (-1, 3)
+    vec2 position = vec2(float((gl_VertexID & 1) * 4 - 1), float((gl_VertexID >> 1) * 4 - 1));
+    // Kierunek promienia widoku z punktu na dalekiej plaszczyznie
+    vec4 world = inverseViewProjection * vec4(position, 1.0, 1.0);
+    Direction = world.xyz / world.w;
+    // z = w: na dalekiej plaszczyznie, glebia 1.0
+    gl_Position = vec4(position, 1.0, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+layout (location = 0) out uint Feedback;
+
+in vec2 TexCoords;
+
+// Tile of the virtual texture the scene shader would sample here (VirtualTextureFeedback):
+// valid bit, texture index, level, tile row and column
+uniform vec4 virtualInfo; // width, height, levels, tile size
+uniform int virtualIndex;
+uniform float lodOffset;  // the feedback target is smaller than the screen
+
+void main()
+{
+    // Same level and tile as sampleVirtual in fragment_shader.glsl
+    vec2 texel = TexCoords * virtualInfo.xy;
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8)) + lodOffset;
+    int level = int(clamp(floor(lod), 0.0, virtualInfo.z - 1.0));
+    vec2 levelSize = max(virtualInfo.xy / exp2(float(level)), vec2(1.0));
+    vec2 tiles = ceil(levelSize / virtualInfo.w);
+    vec2 uv = vec2(fract(TexCoords.x), clamp(TexCoords.y, 0.0, 1.0));
+    uvec2 tile = uvec2(clamp(floor(uv * levelSize / virtualInfo.w), vec2(0.0), tiles - 1.0));
+    Feedback = 0x80000000u | uint(virtualIndex) << 29 | uint(level) << 24 | tile.y << 12 | tile.x;
+}
@@ -1,54 +1,305 @@
-#version 330 core
-out vec4 FragColor;
-
-in vec3 FragPos;
-in vec3 Normal;
-in vec2 TexCoords;
-
-#define NUM_LIGHTS 4
-
-uniform vec3 lightPos[NUM_LIGHTS];
-uniform vec3 viewPos;
-uniform sampler2D texture1;
-
-uniform bool isSun;
-
-void main()
-{
-    vec3 result;
-
-    if (isSun)
-    {
-        // Emissive lighting for the sun
-        vec3 emission = texture(texture1, TexCoords).rgb;
-        result = emission;
-    }
-    else
-    {
-        //moc slonca / swiatla
-        vec3 ambient = 0.3 * texture(texture1, TexCoords).rgb;
-        vec3 diffuse = vec3(0.0);
-        vec3 specular = vec3(0.0);
-        
-        vec3 norm = normalize(Normal);
-        vec3 viewDir = normalize(viewPos - FragPos);
-        float specularStrength = 0.1;
-        
-        for (int i = 0; i < NUM_LIGHTS; ++i)
-        {
-            // Diffuse
-            vec3 lightDir = normalize(lightPos[i] - FragPos);
-            float diff = max(dot(norm, lightDir), 0.0);
-            diffuse += diff * texture(texture1, TexCoords).rgb;
-            
-            // Specular
-            vec3 reflectDir = reflect(-lightDir, norm);
-            float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-            specular += specularStrength * spec * vec3(1.0);
-        }
-
-        result = ambient + diffuse / NUM_LIGHTS + specular / NUM_LIGHTS;
-    }
-
-    FragColor = vec4(result, 1.0);
+#version 330 core
+out vec4 FragColor;
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+#define NUM_LIGHTS 4
+
+uniform vec3 lightPos[NUM_LIGHTS];
+uniform vec3 viewPos;
+
+#ifdef INSTANCED
+// Per-instance layer of the body texture array, emissive flag and procedural surface
+uniform sampler2DArray bodyTextures;
+flat in float Layer;
+flat in float Emissive;
+flat in float Surface;
+
+// Virtual textures (VirtualTexture.h) for layers -1 and -2: page table, tile cache,
+// width, height, levels, tile size and cache border, slot size, cache size in texels
+uniform usampler2D virtualPageTable0;
+uniform sampler2D virtualCache0;
+uniform vec4 virtualInfo0;
+uniform vec3 virtualLayout0;
+uniform usampler2D virtualPageTable1;
+uniform sampler2D virtualCache1;
+uniform vec4 virtualInfo1;
+uniform vec3 virtualLayout1;
+
+vec3 sampleVirtual(usampler2D pageTable, sampler2D cache, vec4 info, vec3 cacheLayout, vec2 uv)
+{
+    // Same level and tile as feedback_fragment_shader.glsl
+    vec2 texel = uv * info.xy;
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8));
+    int level = int(clamp(floor(lod), 0.0, info.z - 1.0));
+    // u wraps like a repeating texture (terrain chunks across the seam go past 1), the lod above used the unwrapped uv
+    uv = vec2(fract(uv.x), clamp(uv.y, 0.0, 1.0));
+    vec2 levelSize = max(info.xy / exp2(float(level)), vec2(1.0));
+    ivec2 page = min(ivec2(uv * levelSize / info.w), textureSize(pageTable, level) - 1);
+    uint entry = texelFetch(pageTable, page, level).r;
+
+    // The entry may be a coarser ancestor's tile, find the texel inside that one
+    vec2 mappedSize = max(info.xy / exp2(float(entry >> 16 & 0xFFu)), vec2(1.0));
+    vec2 position = uv * mappedSize;
+    vec2 tile = min(floor(position / info.w), ceil(mappedSize / info.w) - 1.0);
+    vec2 slot = vec2(float(entry & 0xFFu), float(entry >> 8 & 0xFFu));
+    vec2 cacheTexel = slot * cacheLayout.y + cacheLayout.x + position - tile * info.w;
+    return textureLod(cache, cacheTexel / cacheLayout.z, 0.0).rgb;
+}
+
+vec3 albedo(vec2 uv)
+{
+    if (Layer < -1.5)
+        return sampleVirtual(virtualPageTable1, virtualCache1, virtualInfo1, virtualLayout1, uv);
+    if (Layer < 0.0)
+        return sampleVirtual(virtualPageTable0, virtualCache0, virtualInfo0, virtualLayout0, uv);
+    return texture(bodyTextures, vec3(uv, Layer)).rgb;
+}
+
+bool emissive()
+{
+    return Emissive > 0.5;
+}
+
+int surface()
+{
+    return int(Surface + 0.5);
+}
+#else
+uniform sampler2D texture1;
+uniform bool isSun;
+uniform int proceduralSurface;
+
+vec3 albedo(vec2 uv)
+{
+    return texture(texture1, uv).rgb;
+}
+
+bool emissive()
+{
+    return isSun;
+}
+
+int surface()
+{
+    return proceduralSurface;
+}
+#endif
+
+// Procedural surfaces without a texture: 1 sun, 2 Jupiter, 3 Saturn, 4 Uranus, 5 Neptune.
+// Evaluated on the unit sphere direction, so there is no seam and no texel size; octaves
+// are added until they get finer than a pixel, which keeps them sharp at any zoom.
+const float PI = 3.14159265358979;
+const int MAX_OCTAVES = 16;
+
+// Pseudo-random gradient per lattice point, components in [-1, 1]
+vec3 hash(vec3 p)
+{
+    p = fract(p * vec3(0.1031, 0.1030, 0.0973));
+    p += dot(p, p.yxz + 33.33);
+    return fract((p.xxy + p.yxx) * p.zyx) * 2.0 - 1.0;
+}
+
+float corner(vec3 i, vec3 f, vec3 offset)
+{
+    return dot(hash(i + offset), f - offset);
+}
+
+// Gradient noise, about [-1, 1], with quintic interpolation
+float noise(vec3 p)
+{
+    vec3 i = floor(p);
+    vec3 f = fract(p);
+    vec3 u = f * f * f * (f * (f * 6.0 - 15.0) + 10.0);
+    float x00 = mix(corner(i, f, vec3(0.0, 0.0, 0.0)), corner(i, f, vec3(1.0, 0.0, 0.0)), u.x);
+    float x10 = mix(corner(i, f, vec3(0.0, 1.0, 0.0)), corner(i, f, vec3(1.0, 1.0, 0.0)), u.x);
+    float x01 = mix(corner(i, f, vec3(0.0, 0.0, 1.0)), corner(i, f, vec3(1.0, 0.0, 1.0)), u.x);
+    float x11 = mix(corner(i, f, vec3(0.0, 1.0, 1.0)), corner(i, f, vec3(1.0, 1.0, 1.0)), u.x);
+    return 1.5 * mix(mix(x00, x10, u.y), mix(x01, x11, u.y), u.z);
+}
+
+// Turns each octave's lattice away from the previous one's, hiding the grid
+const mat3 OCTAVE_ROTATION = mat3(0.00, 0.80, 0.60, -0.80, 0.36, -0.48, -0.60, -0.48, 0.64);
+
+// Octaves from p up, footprint is one pixel's size in units of p. An octave fades out
+// between a quarter and half a cell per pixel, the loop stops at the first invisible one.
+float fbm(vec3 p, float footprint, int octaves)
+{
+    float sum = 0.0;
+    float amplitude = 0.5;
+    for (int i = 0; i < octaves; ++i)
+    {
+        float fade = clamp(2.0 - 4.0 * footprint, 0.0, 1.0);
+        if (fade <= 0.0)
+            break;
+        sum += fade * amplitude * noise(p);
+        p = OCTAVE_ROTATION * p * 2.03 + vec3(1.7, 9.2, 5.3);
+        footprint *= 2.03;
+        amplitude *= 0.5;
+    }
+    return sum;
+}
+
+// Per gas giant (surface 2..5): band colours, bands from pole to pole, turbulence of
+// the band edges and a storm (latitude, longitude, radius in radians, strength)
+const vec3 bandLight[4] = vec3[4](vec3(0.90, 0.84, 0.74), vec3(0.91, 0.83, 0.62), vec3(0.72, 0.89, 0.91), vec3(0.40, 0.56, 0.90));
+const vec3 bandDark[4] = vec3[4](vec3(0.64, 0.44, 0.30), vec3(0.74, 0.60, 0.40), vec3(0.60, 0.80, 0.85), vec3(0.18, 0.30, 0.70));
+const float bandCount[4] = float[4](14.0, 18.0, 5.0, 9.0);
+const float turbulence[4] = float[4](1.0, 0.5, 0.15, 0.6);
+const vec4 storm[4] = vec4[4](vec4(-0.39, 1.2, 0.13, 1.0), vec4(0.0), vec4(0.0), vec4(-0.38, 2.6, 0.09, 1.0));
+const vec3 stormColor[4] = vec3[4](vec3(0.76, 0.38, 0.24), vec3(0.0), vec3(0.0), vec3(0.10, 0.16, 0.42));
+
+vec3 gasGiant(int giant, vec3 direction, float footprint)
+{
+    // Latitude pushed around by noise stretched along the bands, so their edges swirl
+    const vec3 stretch = vec3(3.0, 12.0, 3.0);
+    float warp = fbm(direction * stretch, footprint * 12.0, MAX_OCTAVES);
+    float latitude = direction.y + 0.04 * turbulence[giant] * warp;
+
+    // Two band frequencies for uneven widths, faded to their mean once a band is under a pixel
+    float bands = bandCount[giant];
+    float pattern = 0.65 * sin(latitude * bands * PI) + 0.35 * sin(latitude * bands * 1.73 * PI + 1.3);
+    pattern *= clamp(1.5 - footprint * bands * 1.73, 0.0, 1.0);
+    vec3 color = mix(bandDark[giant], bandLight[giant], 0.5 + 0.5 * pattern);
+
+    // Streaks along the flow and darker, hazier poles
+    float streaks = fbm(direction * vec3(8.0, 48.0, 8.0) + vec3(float(giant) * 7.0), footprint * 48.0, MAX_OCTAVES);
+    color *= 1.0 + 0.12 * turbulence[giant] * streaks;
+    color = mix(color, bandDark[giant] * 0.8, smoothstep(0.8, 0.98, abs(direction.y)) * 0.6);
+
+    // Oval storm, twice as long as it is wide, with a noisy rim
+    vec4 spot = storm[giant];
+    if (spot.w > 0.0)
+    {
+        float longitude = atan(direction.z, direction.x);
+        float dLongitude = mod(longitude - spot.y + PI, 2.0 * PI) - PI;
+        vec2 offset = vec2(dLongitude * cos(spot.x) * 0.5, asin(clamp(direction.y, -1.0, 1.0)) - spot.x) / spot.z;
+        float rim = length(offset) + 0.15 * fbm(direction * 24.0, footprint * 24.0, MAX_OCTAVES);
+        color = mix(color, stormColor[giant], spot.w * (1.0 - smoothstep(0.6, 1.0, rim)));
+    }
+    return color;
+}
+
+// Granulation in two scales, darkened towards the limb: I(mu) = 1 - u (1 - mu), where mu is
+// the cosine between the normal and the view ray and u is stronger for blue than for red
+vec3 sunSurface(vec3 direction, float footprint, float mu)
+{
+    float granules = fbm(direction * 40.0, footprint * 40.0, MAX_OCTAVES);
+    float supergranules = fbm(direction * 6.0 + vec3(3.1), footprint * 6.0, 4);
+    vec3 color = mix(vec3(1.0, 0.58, 0.16), vec3(1.0, 0.93, 0.62), clamp(0.6 + 0.8 * granules + 0.3 * supergranules, 0.0, 1.0));
+    vec3 limb = vec3(0.45, 0.6, 0.75);
+    return color * (1.0 - limb * (1.0 - clamp(mu, 0.0, 1.0)));
+}
+
+vec3 proceduralAlbedo(int kind, vec3 direction, float footprint, float mu)
+{
+    if (kind == 1)
+        return sunSurface(direction, footprint, mu);
+    return gasGiant(kind - 2, direction, footprint);
+}
+
+#ifdef IMPOSTOR
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// Ray from the camera through the impostor quad against the sphere given by model. A miss
+// returns false with the silhouette point nearest the ray, so the caller can take
+// derivatives in uniform control flow and discard afterwards.
+bool traceSphere(out vec3 position, out vec3 normal, out vec2 texCoords)
+{
+    vec3 center = vec3(model[3]);
+    float radius = length(vec3(model[0]));
+    vec3 rayDir = normalize(FragPos - viewPos);
+    vec3 oc = viewPos - center;
+    float b = dot(oc, rayDir);
+    float h = b * b - dot(oc, oc) + radius * radius;
+    bool hit = h >= 0.0;
+
+    position = viewPos + (-b - sqrt(max(h, 0.0))) * rayDir;
+    normal = hit ? (position - center) / radius : normalize(position - center);
+    position = center + normal * radius;
+
+    // Same mapping as Object::generateSphere, model only rotates and scales uniformly
+    vec3 local = normalize(transpose(mat3(model)) * normal);
+    float u = atan(local.z, local.x) / (2.0 * PI);
+    float v = acos(clamp(local.y, -1.0, 1.0)) / PI;
+
+    // Pick the u without the wrap-around jump so mip selection stays correct on the seam
+    float uFract = fract(u);
+    float uCentered = fract(u + 0.5) - 0.5;
+    texCoords = vec2(fwidth(uFract) <= fwidth(uCentered) ? uFract : uCentered, v);
+
+    vec4 clip = projection * view * vec4(position, 1.0);
+    gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;
+    return hit;
+}
+#endif
+
+void main()
+{
+    vec3 position = FragPos;
+    vec3 normal = Normal;
+    vec2 texCoords = TexCoords;
+#ifdef IMPOSTOR
+    bool hit = traceSphere(position, normal, texCoords);
+#endif
+
+    // Same point on the unit sphere as the texture mapping; its derivatives come before any
+    // branch, and impostor misses are only discarded at the end of main
+    vec3 direction = vec3(cos(texCoords.x * 2.0 * PI) * sin(texCoords.y * PI),
+                          cos(texCoords.y * PI),
+                          sin(texCoords.x * 2.0 * PI) * sin(texCoords.y * PI));
+    float footprint = length(fwidth(direction));
+
+    vec3 result;
+    vec3 color;
+    if (surface() > 0)
+        color = proceduralAlbedo(surface(), direction, footprint, dot(normalize(normal), normalize(viewPos - position)));
+    else
+        color = albedo(texCoords);
+
+    if (emissive())
+    {
+        // Emissive lighting for the sun
+        vec3 emission = color;
+        result = emission;
+    }
+    else
+    {
+        //moc slonca / swiatla
+        vec3 ambient = 0.3 * color;
+        vec3 diffuse = vec3(0.0);
+        vec3 specular = vec3(0.0);
+        
+        vec3 norm = normalize(normal);
+        vec3 viewDir = normalize(viewPos - position);
+        float specularStrength = 0.1;
+        
+        for (int i = 0; i < NUM_LIGHTS; ++i)
+        {
+            // Diffuse
+            vec3 lightDir = normalize(lightPos[i] - position);
+            float diff = max(dot(norm, lightDir), 0.0);
+            diffuse += diff * color;
+            
+            // Specular
+            vec3 reflectDir = reflect(-lightDir, norm);
+            float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+            specular += specularStrength * spec * vec3(1.0);
+        }
+
+        result = ambient + diffuse / NUM_LIGHTS + specular / NUM_LIGHTS;
+    }
+
+#ifdef IMPOSTOR
+    // Only here, so the derivatives above saw every pixel of each 2x2 block
+    if (!hit)
+        discard;
+#endif
+    FragColor = vec4(result, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+#version 330 core
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+
+// Triangle strip covering [-1, 1]^2
+const vec2 corners[4] = vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+
+void main()
+{
+    vec2 corner = corners[gl_VertexID];
+    vec3 center = vec3(model[3]);
+    float radius = length(vec3(model[0]));
+
+    // Quad through the centre facing the camera, large enough to contain the sphere's silhouette
+    vec3 toCenter = center - viewPos;
+    float distance = max(length(toCenter), radius * 1.001);
+    vec3 forward = toCenter / distance;
+    vec3 cameraUp = vec3(view[0][1], view[1][1], view[2][1]);
+    vec3 right = normalize(cross(forward, cameraUp));
+    vec3 up = cross(right, forward);
+    float extent = radius * distance / sqrt(distance * distance - radius * radius);
+
+    FragPos = center + (corner.x * right + corner.y * up) * extent;
+    Normal = -forward;
+    TexCoords = corner * 0.5 + 0.5;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 viewProjection;
+uniform vec3 center;
+uniform float radius;
+
+void main()
+{
+    // Cube enclosing the bounding sphere
+    gl_Position = viewProjection * vec4(center + aPos * radius, 1.0);
+}
@@ -0,0 +1,51 @@
+#version 330 core
+layout (location = 0) in vec4 aShape;   // semi-major axis, eccentricity, inclination, ascending node
+layout (location = 1) in vec4 aMotion;  // phase at time 0, angular speed
+layout (location = 2) in vec4 aColor;
+
+out vec4 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+uniform float time;
+uniform float projectionScale;
+uniform int maxSegments;
+
+const float PI = 3.14159265358979;
+
+void main()
+{
+    float a = aShape.x;
+    float e = aShape.y;
+
+    // Segment count from the orbit radius on screen, about 8 pixels per segment
+    float distance = max(abs(length(viewPos) - a), 0.01 * a);
+    float pixels = a * projectionScale / distance;
+    int segments = clamp(int(2.0 * PI * pixels / 8.0), 16, maxSegments);
+
+    // GL_LINES: vertex pair k draws the segment from point k to point k + 1
+    int line = gl_VertexID / 2;
+    if (line >= segments)
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        Color = vec4(0.0);
+        return;
+    }
+    float anomaly = 2.0 * PI * float(line + gl_VertexID % 2) / float(segments);
+
+    // Ellipse with the sun in the focus, same direction of motion as the planets
+    vec3 position = vec3(a * (cos(anomaly) - e), 0.0, -a * sqrt(1.0 - e * e) * sin(anomaly));
+    float cosI = cos(aShape.z), sinI = sin(aShape.z);
+    position = vec3(position.x, -position.z * sinI, position.z * cosI);
+    float cosN = cos(aShape.w), sinN = sin(aShape.w);
+    position = vec3(position.x * cosN + position.z * sinN, position.y, -position.x * sinN + position.z * cosN);
+
+    // Bright at the body, fading along the path behind it; tiny orbits fade out entirely
+    float body = aMotion.x + aMotion.y * time;
+    float behind = fract((body - anomaly) / (2.0 * PI));
+    float alpha = mix(1.0, 0.15, behind) * smoothstep(8.0, 32.0, pixels);
+    Color = vec4(aColor.rgb, aColor.a * alpha);
+
+    gl_Position = projection * view * vec4(position, 1.0);
+}
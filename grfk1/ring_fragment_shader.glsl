@@ -0,0 +1,42 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 LocalPos;
+in vec3 LocalViewPos;
+in vec3 LocalSunPos;
+
+uniform sampler2D texture1;
+uniform float innerRadius;
+uniform float outerRadius;
+
+// Width of the planet's shadow edge, in planet radii
+const float PENUMBRA = 0.04;
+
+void main()
+{
+    // View ray against the plane y = 0, then against the annulus
+    vec3 rayDir = LocalPos - LocalViewPos;
+    if (abs(rayDir.y) < 1e-6)
+        discard;
+    vec3 hit = LocalViewPos - rayDir * (LocalViewPos.y / rayDir.y);
+    float radius = length(hit.xz);
+    if (radius < innerRadius || radius > outerRadius)
+        discard;
+
+    // Texture runs radially from the inner (u = 0) to the outer edge (u = 1)
+    vec4 color = texture(texture1, vec2((radius - innerRadius) / (outerRadius - innerRadius), 0.5));
+    if (color.a < 0.01)
+        discard;
+
+    // Shadow of the planet: does the ray towards the sun pass through the unit sphere?
+    vec3 toSun = normalize(LocalSunPos - hit);
+    float along = dot(-hit, toSun);
+    float shadow = 1.0;
+    if (along > 0.0)
+    {
+        float missDistance = sqrt(max(dot(hit, hit) - along * along, 0.0));
+        shadow = smoothstep(1.0 - PENUMBRA, 1.0 + PENUMBRA, missDistance);
+    }
+
+    FragColor = vec4(color.rgb * (0.3 + 0.7 * shadow), color.a);
+}
@@ -0,0 +1,27 @@
+#version 330 core
+out vec3 LocalPos;
+out vec3 LocalViewPos;
+out vec3 LocalSunPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+uniform vec3 sunPos;
+uniform float outerRadius;
+
+// Triangle strip covering [-1, 1]^2
+const vec2 corners[4] = vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+
+void main()
+{
+    // Square in the planet's equatorial plane enclosing the outer edge
+    LocalPos = vec3(corners[gl_VertexID].x, 0.0, corners[gl_VertexID].y) * outerRadius;
+
+    // Camera and sun in planet space, where the planet is the unit sphere
+    mat4 toLocal = inverse(model);
+    LocalViewPos = vec3(toLocal * vec4(viewPos, 1.0));
+    LocalSunPos = vec3(toLocal * vec4(sunPos, 1.0));
+
+    gl_Position = projection * view * model * vec4(LocalPos, 1.0);
+}
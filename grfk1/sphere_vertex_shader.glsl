@@ -0,0 +1,53 @@
+#version 330 core
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+#ifdef INSTANCED
+// Per-instance data from BodyInstances
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in mat3 aNormalMatrix;
+layout (location = 10) in vec3 aLayer; // texture layer, emissive, procedural surface
+flat out float Layer;
+flat out float Emissive;
+flat out float Surface;
+#else
+uniform mat4 model;
+#endif
+uniform mat4 view;
+uniform mat4 projection;
+uniform int longitudeSegments;
+uniform int latitudeSegments;
+
+const float PI = 3.14159265358979;
+
+// Two triangles per quad, same winding as Object::generateSphere
+const ivec2 corners[6] = ivec2[6](ivec2(0, 0), ivec2(0, 1), ivec2(1, 0), ivec2(1, 0), ivec2(0, 1), ivec2(1, 1));
+
+void main()
+{
+#ifdef INSTANCED
+    mat4 model = aModel;
+    mat3 normalMatrix = aNormalMatrix;
+    Layer = aLayer.x;
+    Emissive = aLayer.y;
+    Surface = aLayer.z;
+#else
+    mat3 normalMatrix = mat3(transpose(inverse(model)));
+#endif
+    int quad = gl_VertexID / 6;
+    ivec2 corner = corners[gl_VertexID % 6];
+    float xSegment = float(quad % longitudeSegments + corner.x) / float(longitudeSegments);
+    float ySegment = float(quad / longitudeSegments + corner.y) / float(latitudeSegments);
+
+    // Unit sphere, the position is also the normal
+    vec3 aPos = vec3(cos(xSegment * 2.0 * PI) * sin(ySegment * PI),
+                     cos(ySegment * PI),
+                     sin(xSegment * 2.0 * PI) * sin(ySegment * PI));
+
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = normalMatrix * aPos;
+    TexCoords = vec2(xSegment, ySegment);
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,229 @@
+// Benchmark for draw submission of arena meshes.
+//
+//   drawbench [objects] [frames]
+//
+// Draws the same set of small spheres (a few LODs in one MeshArena) in a hidden window
+// four ways and prints CPU submission time and GPU time (GL_TIME_ELAPSED) per frame:
+//
+//   per-draw        glUniformMatrix4fv + glDrawElementsBaseVertex per object
+//   instanced       one glDrawElementsInstancedBaseVertex per mesh
+//   indirect        one command per object, a single glMultiDrawElementsIndirect
+//   indirect-loop   the same commands through the GL 3.3 fallback loop
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include "../MeshArena.h"
+#include "../StreamBuffer.h"
+#include "../BodyInstances.h"
+#include "../IndirectBatch.h"
+
+static const char* perDrawVertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec3 aNormal;\n"
+    "uniform mat4 model;\n"
+    "uniform mat4 viewProjection;\n"
+    "out vec3 Normal;\n"
+    "void main() {\n"
+    "    Normal = mat3(model) * aNormal;\n"
+    "    gl_Position = viewProjection * model * vec4(aPos, 1.0);\n"
+    "}\n";
+
+static const char* instancedVertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec3 aNormal;\n"
+    "layout (location = 3) in mat4 aModel;\n"
+    "layout (location = 7) in mat3 aNormalMatrix;\n"
+    "uniform mat4 viewProjection;\n"
+    "out vec3 Normal;\n"
+    "void main() {\n"
+    "    Normal = aNormalMatrix * aNormal;\n"
+    "    gl_Position = viewProjection * aModel * vec4(aPos, 1.0);\n"
+    "}\n";
+
+static const char* fragmentSource =
+    "#version 330 core\n"
+    "in vec3 Normal;\n"
+    "out vec4 FragColor;\n"
+    "void main() {\n"
+    "    FragColor = vec4(vec3(0.2 + 0.8 * max(dot(normalize(Normal), normalize(vec3(1.0, 1.0, 0.5))), 0.0)), 1.0);\n"
+    "}\n";
+
+static unsigned int compileProgram(const char* vertexSource, const char* fragmentSource) {
+    unsigned int shaders[2] = { glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER) };
+    const char* sources[2] = { vertexSource, fragmentSource };
+    unsigned int program = glCreateProgram();
+    for (int s = 0; s < 2; ++s) {
+        glShaderSource(shaders[s], 1, &sources[s], NULL);
+        glCompileShader(shaders[s]);
+        int success;
+        glGetShaderiv(shaders[s], GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[1024];
+            glGetShaderInfoLog(shaders[s], 1024, NULL, infoLog);
+            std::cerr << "ERROR::SHADER_COMPILATION_ERROR\n" << infoLog << std::endl;
+        }
+        glAttachShader(program, shaders[s]);
+    }
+    glLinkProgram(program);
+    glDeleteShader(shaders[0]);
+    glDeleteShader(shaders[1]);
+    return program;
+}
+
+// UV sphere in the arena vertex layout (position, normal, uv)
+static MeshHandle uploadSphere(MeshArena& arena, unsigned int segments) {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    unsigned int rings = segments / 2;
+    const float pi = 3.14159265358979f;
+    for (unsigned int y = 0; y <= rings; ++y) {
+        for (unsigned int x = 0; x <= segments; ++x) {
+            float u = (float)x / segments, v = (float)y / rings;
+            glm::vec3 p(std::cos(u * 2.0f * pi) * std::sin(v * pi), std::cos(v * pi), std::sin(u * 2.0f * pi) * std::sin(v * pi));
+            float vertex[8] = { p.x, p.y, p.z, p.x, p.y, p.z, u, v };
+            vertices.insert(vertices.end(), vertex, vertex + 8);
+        }
+    }
+    for (unsigned int y = 0; y < rings; ++y) {
+        for (unsigned int x = 0; x < segments; ++x) {
+            unsigned int i1 = y * (segments + 1) + x;
+            unsigned int i2 = i1 + segments + 1;
+            unsigned int quad[6] = { i1, i2, i1 + 1, i1 + 1, i2, i2 + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+    return arena.upload("", vertices.data(), vertices.size(), indices.data(), indices.size());
+}
+
+int main(int argc, char** argv) {
+    unsigned int objectCount = argc >= 2 ? (unsigned int)std::max(1, atoi(argv[1])) : 4000;
+    unsigned int frames = argc >= 3 ? (unsigned int)std::max(1, atoi(argv[2])) : 200;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(512, 512, "drawbench", NULL, NULL);
+    if (window == NULL) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return 1;
+    }
+    StreamBuffer::loadExtensions((GLADloadproc)glfwGetProcAddress);
+    IndirectBatch::loadExtensions((GLADloadproc)glfwGetProcAddress);
+    std::cout << "GL " << GLVersion.major << "." << GLVersion.minor << ", " << objectCount << " objects, " << frames << " frames"
+              << (IndirectBatch::multiDrawSupported() ? "" : ", no multi-draw indirect (indirect = loop)") << std::endl;
+
+    {
+        MeshArena arena;
+        const unsigned int segments[] = { 6, 8, 10, 12, 16, 20 };
+        const unsigned int meshCount = sizeof(segments) / sizeof(segments[0]);
+        MeshHandle meshes[meshCount];
+        for (unsigned int m = 0; m < meshCount; ++m)
+            meshes[m] = uploadSphere(arena, segments[m]);
+
+        // Objects on a grid in front of the camera, mesh chosen round-robin
+        unsigned int side = (unsigned int)std::ceil(std::sqrt((double)objectCount));
+        std::vector<BodyInstance> objects(objectCount);
+        std::vector<std::vector<BodyInstance>> byMesh(meshCount);
+        for (unsigned int i = 0; i < objectCount; ++i) {
+            glm::vec3 position(((float)(i % side) + 0.5f) / side * 2.0f - 1.0f, ((float)(i / side) + 0.5f) / side * 2.0f - 1.0f, 0.0f);
+            objects[i].model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(0.8f / side));
+            objects[i].layer = 0.0f;
+            objects[i].emissive = false;
+            objects[i].surface = 0;
+            byMesh[i % meshCount].push_back(objects[i]);
+        }
+
+        StreamBuffer stream(objectCount * (BodyInstances::FLOATS_PER_INSTANCE * sizeof(float) + sizeof(DrawElementsIndirectCommand)) + (1 << 16));
+        BodyInstances bodies(stream);
+        IndirectBatch batch;
+        unsigned int perDrawProgram = compileProgram(perDrawVertexSource, fragmentSource);
+        unsigned int instancedProgram = compileProgram(instancedVertexSource, fragmentSource);
+        glm::mat4 viewProjection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
+        for (unsigned int program : { perDrawProgram, instancedProgram }) {
+            glUseProgram(program);
+            glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+        }
+        GLint modelLocation = glGetUniformLocation(perDrawProgram, "model");
+
+        unsigned int query;
+        glGenQueries(1, &query);
+        glEnable(GL_DEPTH_TEST);
+
+        const char* names[] = { "per-draw", "instanced", "indirect", "indirect-loop" };
+        std::cout << std::fixed << std::setprecision(3);
+        for (int mode = 0; mode < 4; ++mode) {
+            double cpuTotal = 0.0, gpuTotal = 0.0;
+            unsigned int calls = 0;
+            for (unsigned int frame = 0; frame < frames; ++frame) {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                glBeginQuery(GL_TIME_ELAPSED, query);
+                std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+                if (mode == 0) {
+                    glUseProgram(perDrawProgram);
+                    arena.bind();
+                    for (unsigned int i = 0; i < objectCount; ++i) {
+                        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(objects[i].model));
+                        arena.draw(meshes[i % meshCount]);
+                    }
+                    calls = objectCount;
+                }
+                else if (mode == 1) {
+                    glUseProgram(instancedProgram);
+                    glBindVertexArray(bodies.meshVertexArray());
+                    for (unsigned int m = 0; m < meshCount; ++m)
+                        bodies.drawMesh(arena, meshes[m], byMesh[m]);
+                    calls = meshCount;
+                }
+                else {
+                    // The command stream is rebuilt every frame, as in the renderer
+                    batch.clear();
+                    for (unsigned int i = 0; i < objectCount; ++i)
+                        batch.addDraw(meshes[i % meshCount], batch.addInstance(objects[i]));
+                    glUseProgram(instancedProgram);
+                    glBindVertexArray(bodies.meshVertexArray());
+                    batch.draw(bodies, arena, stream, mode == 2);
+                    calls = mode == 2 && IndirectBatch::multiDrawSupported() ? 1 : objectCount;
+                }
+                std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+                glEndQuery(GL_TIME_ELAPSED);
+                stream.endFrame();
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                cpuTotal += std::chrono::duration<double, std::milli>(end - start).count();
+                gpuTotal += elapsed / 1.0e6;
+            }
+            std::cout << std::setw(14) << std::left << names[mode] << std::right
+                      << "  calls " << std::setw(6) << calls
+                      << "  cpu " << std::setw(8) << cpuTotal / frames << " ms"
+                      << "  gpu " << std::setw(8) << gpuTotal / frames << " ms" << std::endl;
+        }
+
+        glDeleteQueries(1, &query);
+        glDeleteProgram(perDrawProgram);
+        glDeleteProgram(instancedProgram);
+        bodies.destroy();
+        stream.destroy();
+        arena.destroy();
+    }
+    glfwTerminate();
+    return 0;
+}
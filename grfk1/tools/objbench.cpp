@@ -0,0 +1,84 @@
+// Benchmark for ObjLoader.
+//
+//   objbench <file.obj> [repeats]        load a file with 1..N threads and print throughput
+//   objbench --generate <out.obj> <n>    write an n x n segment UV sphere (2*n*n triangles)
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include "../ObjLoader.h"
+
+static bool generateSphere(const char* path, unsigned int segments) {
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+    const double pi = 3.14159265358979323846;
+    for (unsigned int y = 0; y <= segments; ++y) {
+        for (unsigned int x = 0; x <= segments; ++x) {
+            double u = (double)x / segments, v = (double)y / segments;
+            double px = std::cos(u * 2.0 * pi) * std::sin(v * pi);
+            double py = std::cos(v * pi);
+            double pz = std::sin(u * 2.0 * pi) * std::sin(v * pi);
+            fprintf(file, "v %.6f %.6f %.6f\nvn %.6f %.6f %.6f\nvt %.6f %.6f\n", px, py, pz, px, py, pz, u, v);
+        }
+    }
+    for (unsigned int y = 0; y < segments; ++y) {
+        for (unsigned int x = 0; x < segments; ++x) {
+            unsigned int i1 = y * (segments + 1) + x + 1;
+            unsigned int i2 = i1 + segments + 1;
+            fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", i1, i1, i1, i2, i2, i2, i2 + 1, i2 + 1, i2 + 1, i1 + 1, i1 + 1, i1 + 1);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && std::string(argv[1]) == "--generate") {
+        if (!generateSphere(argv[2], (unsigned int)atoi(argv[3]))) {
+            std::cerr << "Failed to write " << argv[2] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (argc < 2) {
+        std::cerr << "usage: objbench <file.obj> [repeats] | objbench --generate <out.obj> <segments>" << std::endl;
+        return 1;
+    }
+
+    int repeats = argc >= 3 ? std::max(1, atoi(argv[2])) : 3;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << std::fixed << std::setprecision(1);
+    // Powers of two, then maxThreads itself when it is not one
+    for (unsigned int threads = 1; threads <= maxThreads; threads = (threads < maxThreads && threads * 2 > maxThreads) ? maxThreads : threads * 2) {
+        // parallelFor also runs work on the calling thread
+        std::unique_ptr<ThreadPool> pool(threads > 1 ? new ThreadPool(threads - 1) : nullptr);
+        double best = 1e30;
+        ObjLoadStats bestStats;
+        for (int r = 0; r < repeats; ++r) {
+            MeshData mesh;
+            ObjLoadStats stats;
+            if (!ObjLoader::load(argv[1], mesh, &stats, pool.get())) {
+                std::cerr << "Failed to load " << argv[1] << std::endl;
+                return 1;
+            }
+            if (stats.totalMs < best) {
+                best = stats.totalMs;
+                bestStats = stats;
+            }
+        }
+        double megabytes = bestStats.fileBytes / (1024.0 * 1024.0);
+        std::cout << "threads " << std::setw(2) << threads
+                  << "  chunks " << std::setw(2) << bestStats.threads
+                  << "  read " << std::setw(7) << bestStats.readMs << " ms"
+                  << "  parse " << std::setw(7) << bestStats.parseMs << " ms"
+                  << "  dedup " << std::setw(7) << bestStats.dedupMs << " ms"
+                  << "  total " << std::setw(7) << bestStats.totalMs << " ms"
+                  << "  " << std::setw(6) << megabytes / (best / 1000.0) << " MB/s"
+                  << "  " << std::setw(5) << bestStats.triangles / (best * 1000.0) << " Mtri/s"
+                  << "  (" << bestStats.triangles << " tris, " << bestStats.uniqueVertices << " verts)" << std::endl;
+    }
+    return 0;
+}
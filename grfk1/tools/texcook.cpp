@@ -0,0 +1,277 @@
+// Offline texture cooker.
+//
+//   texcook <image> [image...]    write <image>.gktx next to each source image
+//
+// Builds the full mip chain with MipGenerator (Kaiser filter in linear space, split across
+// a thread pool), compresses every level to BC1 (images without alpha) or BC3 (images
+// with alpha) and stores it in the CompressedTexture container that Texture and
+// TextureLoader prefer over the source.
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <sys/stat.h>
+#include "../CompressedTexture.h"
+#include "../MipGenerator.h"
+
+struct Image {
+    int width;
+    int height;
+    int channels; // 3 or 4
+    std::vector<unsigned char> pixels;
+};
+
+static uint16_t packColor(const float* color) {
+    int r = (int)std::lround(std::min(255.0f, std::max(0.0f, color[0])) * 31.0f / 255.0f);
+    int g = (int)std::lround(std::min(255.0f, std::max(0.0f, color[1])) * 63.0f / 255.0f);
+    int b = (int)std::lround(std::min(255.0f, std::max(0.0f, color[2])) * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpackColor(uint16_t packed, float* color) {
+    color[0] = (float)((packed >> 11) & 31) * 255.0f / 31.0f;
+    color[1] = (float)((packed >> 5) & 63) * 255.0f / 63.0f;
+    color[2] = (float)(packed & 31) * 255.0f / 31.0f;
+}
+
+// Pick the nearest of the four palette colors per texel, returns the squared error
+static float chooseIndices(const float texels[16][3], uint16_t color0, uint16_t color1, uint32_t& indices) {
+    float palette[4][3];
+    unpackColor(color0, palette[0]);
+    unpackColor(color1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+        palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+    float total = 0.0f;
+    indices = 0;
+    for (int i = 0; i < 16; ++i) {
+        int best = 0;
+        float bestError = 1e30f;
+        for (int p = 0; p < 4; ++p) {
+            float error = 0.0f;
+            for (int c = 0; c < 3; ++c)
+                error += (texels[i][c] - palette[p][c]) * (texels[i][c] - palette[p][c]);
+            if (error < bestError) {
+                bestError = error;
+                best = p;
+            }
+        }
+        indices |= (uint32_t)best << (2 * i);
+        total += bestError;
+    }
+    return total;
+}
+
+// Four-color mode needs color0 > color1; swapping the endpoints maps index 0<->1 and 2<->3
+static void orderEndpoints(uint16_t& color0, uint16_t& color1, uint32_t& indices) {
+    if (color0 >= color1)
+        return;
+    std::swap(color0, color1);
+    indices ^= 0x55555555u;
+}
+
+// BC1 color block: endpoints along the principal axis (inset a little), nearest indices,
+// then one least-squares refit of the endpoints for those indices
+static void encodeColorBlock(const float texels[16][3], unsigned char* out) {
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c)
+            mean[c] += texels[i][c] / 16.0f;
+    float covariance[6] = {};
+    for (int i = 0; i < 16; ++i) {
+        float d[3] = { texels[i][0] - mean[0], texels[i][1] - mean[1], texels[i][2] - mean[2] };
+        covariance[0] += d[0] * d[0]; covariance[1] += d[0] * d[1]; covariance[2] += d[0] * d[2];
+        covariance[3] += d[1] * d[1]; covariance[4] += d[1] * d[2]; covariance[5] += d[2] * d[2];
+    }
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[3] = {
+            covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+            covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+            covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]
+        };
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f)
+            break;
+        for (int c = 0; c < 3; ++c)
+            axis[c] = next[c] / length;
+    }
+    float lowest = 1e30f, highest = -1e30f;
+    for (int i = 0; i < 16; ++i) {
+        float t = (texels[i][0] - mean[0]) * axis[0] + (texels[i][1] - mean[1]) * axis[1] + (texels[i][2] - mean[2]) * axis[2];
+        lowest = std::min(lowest, t);
+        highest = std::max(highest, t);
+    }
+    float inset = (highest - lowest) / 16.0f;
+    float end0[3], end1[3];
+    for (int c = 0; c < 3; ++c) {
+        end0[c] = mean[c] + axis[c] * (highest - inset);
+        end1[c] = mean[c] + axis[c] * (lowest + inset);
+    }
+    uint16_t color0 = packColor(end0), color1 = packColor(end1);
+    uint32_t indices;
+    float error = chooseIndices(texels, color0, color1, indices);
+
+    // Least squares: texel = a * end0 + b * end1 with (a, b) fixed by each index
+    static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax[3] = {}, bx[3] = {};
+    for (int i = 0; i < 16; ++i) {
+        float a = weights[(indices >> (2 * i)) & 3], b = 1.0f - a;
+        aa += a * a; ab += a * b; bb += b * b;
+        for (int c = 0; c < 3; ++c) {
+            ax[c] += a * texels[i][c];
+            bx[c] += b * texels[i][c];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) > 1e-6f) {
+        float fit0[3], fit1[3];
+        for (int c = 0; c < 3; ++c) {
+            fit0[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+            fit1[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+        }
+        uint16_t refit0 = packColor(fit0), refit1 = packColor(fit1);
+        uint32_t refitIndices;
+        float refitError = chooseIndices(texels, refit0, refit1, refitIndices);
+        if (refitError < error) {
+            color0 = refit0;
+            color1 = refit1;
+            indices = refitIndices;
+        }
+    }
+    if (color0 == color1)
+        indices = 0;
+    orderEndpoints(color0, color1, indices);
+    out[0] = (unsigned char)(color0 & 0xFF);
+    out[1] = (unsigned char)(color0 >> 8);
+    out[2] = (unsigned char)(color1 & 0xFF);
+    out[3] = (unsigned char)(color1 >> 8);
+    for (int b = 0; b < 4; ++b)
+        out[4 + b] = (unsigned char)((indices >> (8 * b)) & 0xFF);
+}
+
+// BC3 alpha block: eight interpolated values between the block's min and max
+static void encodeAlphaBlock(const unsigned char alpha[16], unsigned char* out) {
+    unsigned char lowest = 255, highest = 0;
+    for (int i = 0; i < 16; ++i) {
+        lowest = std::min(lowest, alpha[i]);
+        highest = std::max(highest, alpha[i]);
+    }
+    out[0] = highest;
+    out[1] = lowest;
+    uint64_t indices = 0;
+    if (highest > lowest) {
+        float palette[8];
+        palette[0] = highest;
+        palette[1] = lowest;
+        for (int p = 1; p < 7; ++p)
+            palette[p + 1] = ((7 - p) * (float)highest + p * (float)lowest) / 7.0f;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            float bestError = 1e30f;
+            for (int p = 0; p < 8; ++p) {
+                float error = std::fabs(alpha[i] - palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (3 * i);
+        }
+    }
+    for (int b = 0; b < 6; ++b)
+        out[2 + b] = (unsigned char)((indices >> (8 * b)) & 0xFF);
+}
+
+static std::vector<unsigned char> compress(const Image& image, uint32_t format) {
+    int blocksWide = (image.width + 3) / 4, blocksHigh = (image.height + 3) / 4;
+    std::vector<unsigned char> blocks(CompressedTexture::levelSize(format, image.width, image.height));
+    unsigned char* out = blocks.data();
+    for (int by = 0; by < blocksHigh; ++by) {
+        for (int bx = 0; bx < blocksWide; ++bx) {
+            float texels[16][3];
+            unsigned char alpha[16];
+            for (int i = 0; i < 16; ++i) {
+                // Edge blocks repeat the last row / column
+                int x = std::min(bx * 4 + (i & 3), image.width - 1);
+                int y = std::min(by * 4 + (i >> 2), image.height - 1);
+                const unsigned char* texel = &image.pixels[((size_t)y * image.width + x) * image.channels];
+                for (int c = 0; c < 3; ++c)
+                    texels[i][c] = texel[c];
+                alpha[i] = image.channels == 4 ? texel[3] : 255;
+            }
+            if (format == CompressedTexture::FORMAT_BC3) {
+                encodeAlphaBlock(alpha, out);
+                out += 8;
+            }
+            encodeColorBlock(texels, out);
+            out += 8;
+        }
+    }
+    return blocks;
+}
+
+static long long fileSize(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? (long long)info.st_size : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: texcook <image> [image...]" << std::endl;
+        return 1;
+    }
+    stbi_set_flip_vertically_on_load(true); // Same orientation as Texture
+    ThreadPool workers;
+    int failures = 0;
+    std::cout << std::fixed << std::setprecision(1);
+    for (int a = 1; a < argc; ++a) {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        std::string path = argv[a];
+        int width, height, channels;
+        if (!stbi_info(path.c_str(), &width, &height, &channels)) {
+            std::cerr << "Failed to load " << path << std::endl;
+            ++failures;
+            continue;
+        }
+        Image image;
+        image.channels = channels == 4 || channels == 2 ? 4 : 3;
+        unsigned char* data = stbi_load(path.c_str(), &image.width, &image.height, &channels, image.channels);
+        if (!data) {
+            std::cerr << "Failed to load " << path << std::endl;
+            ++failures;
+            continue;
+        }
+        image.pixels.assign(data, data + (size_t)image.width * image.height * image.channels);
+        stbi_image_free(data);
+
+        uint32_t format = image.channels == 4 ? CompressedTexture::FORMAT_BC3 : CompressedTexture::FORMAT_BC1;
+        std::vector<std::vector<unsigned char>> chain = MipGenerator::build(std::move(image.pixels), image.width, image.height, image.channels, MipGenerator::KAISER, &workers);
+        std::vector<std::vector<unsigned char>> levels;
+        for (std::vector<unsigned char>& pixels : chain) {
+            image.pixels.swap(pixels);
+            levels.push_back(compress(image, format));
+            image.width = std::max(1, image.width / 2);
+            image.height = std::max(1, image.height / 2);
+        }
+
+        std::string output = CompressedTexture::cookedPath(path);
+        if (!CompressedTexture::store(output, format, (uint32_t)width, (uint32_t)height, levels)) {
+            std::cerr << "Failed to write " << output << std::endl;
+            ++failures;
+            continue;
+        }
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        long long sourceBytes = fileSize(path), cookedBytes = fileSize(output);
+        std::cout << path << "  " << width << "x" << height << "  " << (format == CompressedTexture::FORMAT_BC1 ? "BC1" : "BC3")
+                  << "  " << levels.size() << " levels  " << sourceBytes << " -> " << cookedBytes << " bytes ("
+                  << (cookedBytes ? (double)sourceBytes / cookedBytes : 0.0) << "x)  " << milliseconds << " ms" << std::endl;
+    }
+    return failures ? 1 : 0;
+}
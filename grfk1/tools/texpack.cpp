@@ -0,0 +1,48 @@
+// Texture pack builder.
+//
+//   texpack <pack.gkpk> <file> [file...]
+//
+// Stores the files unchanged, each on its own pages, in one TexturePack. Entries are
+// named by their path relative to the working directory, so run it from the directory
+// the program runs in (grfk1): texpack textures/textures.gkpk textures/*.bmp textures/*.gktx
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <sys/stat.h>
+#include "../TexturePack.h"
+
+static long long fileSize(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? (long long)info.st_size : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: texpack <pack.gkpk> <file> [file...]" << std::endl;
+        return 1;
+    }
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    std::string output = argv[1];
+    std::vector<std::string> names, sources;
+    long long sourceBytes = 0;
+    for (int a = 2; a < argc; ++a) {
+        std::string name = TexturePack::name(argv[a]);
+        if (name == TexturePack::name(output))
+            continue;
+        names.push_back(name);
+        sources.push_back(argv[a]);
+        sourceBytes += fileSize(argv[a]);
+    }
+    if (!TexturePack::store(output, names, sources)) {
+        std::cerr << "Failed to write " << output << std::endl;
+        return 1;
+    }
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    for (const std::string& name : names)
+        std::cout << "  " << name << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << output << "  " << names.size() << " files, " << sourceBytes << " -> " << fileSize(output)
+              << " bytes  " << milliseconds << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Offline tiler for virtual textures.
+//
+//   vttile <image> [output.gkvt]    default output: the image path with .gkvt
+//
+// Resamples the image to TILE_SIZE times a power of two in both directions (when it
+// is not already), builds the mip chain with a 2x2 box filter and cuts every level
+// into bordered tiles of the VirtualTextureFile page file. Borders wrap horizontally
+// (equirectangular maps are continuous across u = 0) and clamp vertically. The whole
+// source and one mip level are kept in memory, the tiles are streamed to the file.
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include "../VirtualTexture.h"
+#include "../TextureArray.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+struct Image {
+    uint32_t width;
+    uint32_t height;
+    std::vector<unsigned char> pixels; // RGB
+};
+
+static Image downsample(const Image& source) {
+    Image result;
+    result.width = std::max(1u, source.width / 2);
+    result.height = std::max(1u, source.height / 2);
+    result.pixels.resize((size_t)result.width * result.height * 3);
+    for (uint32_t y = 0; y < result.height; ++y) {
+        for (uint32_t x = 0; x < result.width; ++x) {
+            uint32_t x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+            uint32_t y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+            for (int c = 0; c < 3; ++c) {
+                int sum = source.pixels[((size_t)y0 * source.width + x0) * 3 + c] + source.pixels[((size_t)y0 * source.width + x1) * 3 + c]
+                        + source.pixels[((size_t)y1 * source.width + x0) * 3 + c] + source.pixels[((size_t)y1 * source.width + x1) * 3 + c];
+                result.pixels[((size_t)y * result.width + x) * 3 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+// One bordered tile of a level, rows of SLOT_SIZE texels
+static void cutTile(const Image& level, uint32_t tileX, uint32_t tileY, std::vector<unsigned char>& tile) {
+    const int tileSize = (int)VirtualTextureFile::TILE_SIZE, border = (int)VirtualTextureFile::BORDER, slotSize = (int)VirtualTextureFile::SLOT_SIZE;
+    int width = (int)level.width, height = (int)level.height;
+    for (int y = 0; y < slotSize; ++y) {
+        int sourceY = std::min(std::max((int)tileY * tileSize + y - border, 0), height - 1);
+        for (int x = 0; x < slotSize; ++x) {
+            int sourceX = (((int)tileX * tileSize + x - border) % width + width) % width;
+            memcpy(&tile[((size_t)y * slotSize + x) * 3], &level.pixels[((size_t)sourceY * width + sourceX) * 3], 3);
+        }
+    }
+}
+
+static uint32_t nextPowerOfTwo(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value)
+        result *= 2;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: vttile <image> [output.gkvt]" << std::endl;
+        return 1;
+    }
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    std::string path = argv[1];
+    std::string output = argc > 2 ? argv[2] : path.substr(0, path.find_last_of('.')) + ".gkvt";
+
+    stbi_set_flip_vertically_on_load(true); // Same orientation as Texture
+    int sourceWidth, sourceHeight, channels;
+    unsigned char* data = stbi_load(path.c_str(), &sourceWidth, &sourceHeight, &channels, 3);
+    if (!data) {
+        std::cerr << "Failed to load " << path << std::endl;
+        return 1;
+    }
+    const uint32_t tileSize = VirtualTextureFile::TILE_SIZE;
+    Image image;
+    image.width = tileSize * nextPowerOfTwo((sourceWidth + tileSize - 1) / tileSize);
+    image.height = tileSize * nextPowerOfTwo((sourceHeight + tileSize - 1) / tileSize);
+    if (image.width == (uint32_t)sourceWidth && image.height == (uint32_t)sourceHeight)
+        image.pixels.assign(data, data + (size_t)sourceWidth * sourceHeight * 3);
+    else
+        image.pixels = TextureArray::resample(data, sourceWidth, sourceHeight, (int)image.width, (int)image.height);
+    stbi_image_free(data);
+
+    std::string temporary = output + ".tmp";
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to write " << output << std::endl;
+        return 1;
+    }
+    std::vector<unsigned char> header = VirtualTextureFile::header(image.width, image.height);
+    out.write((const char*)header.data(), (std::streamsize)header.size());
+
+    // Tiles in file order, each padded to the stride
+    std::vector<VirtualTextureFile::Level> levels = VirtualTextureFile::layout(image.width, image.height);
+    std::vector<unsigned char> tile(VirtualTextureFile::TILE_STRIDE, 0);
+    for (size_t level = 0; level < levels.size(); ++level) {
+        if (level > 0)
+            image = downsample(image);
+        for (uint32_t y = 0; y < levels[level].tilesY; ++y) {
+            for (uint32_t x = 0; x < levels[level].tilesX; ++x) {
+                cutTile(image, x, y, tile);
+                out.write((const char*)tile.data(), (std::streamsize)tile.size());
+            }
+        }
+        std::cout << "  level " << level << "  " << image.width << "x" << image.height << "  " << levels[level].tilesX << "x" << levels[level].tilesY << " tiles" << std::endl;
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Failed to write " << output << std::endl;
+        std::remove(temporary.c_str());
+        return 1;
+    }
+    std::remove(output.c_str());
+    if (std::rename(temporary.c_str(), output.c_str()) != 0) {
+        std::cerr << "Failed to write " << output << std::endl;
+        return 1;
+    }
+
+    uint64_t tileCount = levels.back().firstTile + 1;
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(1) << path << "  " << sourceWidth << "x" << sourceHeight << " -> " << levels.size() << " levels, "
+              << tileCount << " tiles, " << (header.size() + tileCount * VirtualTextureFile::TILE_STRIDE) / (1024.0 * 1024.0) << " MB  "
+              << milliseconds << " ms" << std::endl;
+    return 0;
+}